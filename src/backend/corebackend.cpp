@@ -18,11 +18,18 @@
 #include "backend/corebackend.h"
 
 #include "core/device.h"
+#include "core/diskdevice.h"
+#include "core/partition.h"
 #include "core/partitiontable.h"
 
+#include "util/externalcommand.h"
 #include "util/globallog.h"
 
 #include <QDebug>
+#include <QFile>
+#include <QStringList>
+
+#include <KDiskFreeSpaceInfo>
 
 class CoreBackend::CoreBackendPrivate
 {
@@ -59,3 +66,56 @@ void CoreBackend::setPartitionTableMaxPrimaries(PartitionTable& p, qint32 max_pr
 {
     p.setMaxPrimaries(max_primaries);
 }
+
+bool CoreBackend::readSectorsUsed(const DiskDevice& d, Partition& p, const QString& mountPoint)
+{
+    const KDiskFreeSpaceInfo freeSpaceInfo = KDiskFreeSpaceInfo::freeSpaceInfo(mountPoint);
+
+    if (p.isMounted() && freeSpaceInfo.isValid() && mountPoint != QString())
+        p.fileSystem().setSectorsUsed(freeSpaceInfo.used() / d.logicalSectorSize());
+    else if (p.fileSystem().supportGetUsed() == FileSystem::cmdSupportFileSystem)
+        p.fileSystem().setSectorsUsed(p.fileSystem().readUsedCapacity(p.deviceNode()) / d.logicalSectorSize());
+    else
+        return false;
+
+    return true;
+}
+
+QList<Device*> CoreBackend::scanBlockDevices(bool excludeReadOnly)
+{
+    QList<Device*> result;
+    // linux.git/tree/Documentation/devices.txt
+    QString blockDeviceMajorNumbers = QStringLiteral(
+        "3,22,33,34,56,57,88,89,90,91,128,129,130,131,132,133,134,135," // MFM, RLL and IDE hard disk/CD-ROM interface
+        "7," // loop devices
+        "8,65,66,67,68,69,70,71," // SCSI disk devices
+        "80,81,82,83,84,85,86,87," // I2O hard disk
+        "179," // MMC block devices
+        "259" // Block Extended Major (include NVMe)
+    );
+    ExternalCommand cmd(QStringLiteral("lsblk"), {
+                          QStringLiteral("--nodeps"),
+                          QStringLiteral("--noheadings"),
+                          QStringLiteral("--output"), QString::fromLatin1("name"),
+                          QStringLiteral("--paths"),
+                          QStringLiteral("--include"), blockDeviceMajorNumbers});
+    if (cmd.run(-1) && cmd.exitCode() == 0) {
+        QStringList devices = cmd.output().split(QString::fromLatin1("\n"));
+        devices.removeLast();
+        quint32 totalDevices = devices.length();
+        for (quint32 i = 0; i < totalDevices; ++i) {
+            if (excludeReadOnly) {
+                QFile f(QStringLiteral("/sys/block/%1/ro").arg(QString(devices[i]).remove(QStringLiteral("/dev/"))));
+                if (f.open(QIODevice::ReadOnly))
+                    if (f.readLine().trimmed().toInt() == 1)
+                        continue;
+            }
+
+            emitScanProgress(devices[i], i * 100 / totalDevices);
+            if (Device* d = scanDevice(devices[i]))
+                result.append(d);
+        }
+    }
+
+    return result;
+}
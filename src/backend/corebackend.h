@@ -29,6 +29,8 @@
 class CoreBackendManager;
 class CoreBackendDevice;
 class Device;
+class DiskDevice;
+class Partition;
 class PartitionTable;
 
 class QString;
@@ -155,6 +157,22 @@ protected:
     static void setPartitionTableForDevice(Device& d, PartitionTable* p);
     static void setPartitionTableMaxPrimaries(PartitionTable& p, qint32 max_primaries);
 
+    /**
+      * Reads the sectors used in a FileSystem and stores the result in the Partition's FileSystem object.
+      * @param d the Device the Partition is on
+      * @param p the Partition the FileSystem is on
+      * @param mountPoint mount point of the partition in question
+      * @return false if neither the mounted FileSystem nor the FileSystem's tools could report the used space
+      */
+    static bool readSectorsUsed(const DiskDevice& d, Partition& p, const QString& mountPoint);
+
+    /**
+      * Enumerates the disk-like block devices on the system and calls scanDevice() for each of them.
+      * @param excludeReadOnly whether to skip devices the kernel reports as read-only
+      * @return the Devices found. callers need to free them.
+      */
+    QList<Device*> scanBlockDevices(bool excludeReadOnly);
+
 private:
     void setId(const QString& id) {
         m_id = id;
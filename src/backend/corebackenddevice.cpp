@@ -22,3 +22,21 @@ CoreBackendDevice::CoreBackendDevice(const QString& device_node) :
     m_Exclusive(false)
 {
 }
+
+bool CoreBackendDevice::readSegments(const QVector<Segment>& segments)
+{
+    for (const auto &s : segments)
+        if (!readSectors(s.buffer, s.offset, s.numSectors))
+            return false;
+
+    return true;
+}
+
+bool CoreBackendDevice::writeSegments(const QVector<Segment>& segments)
+{
+    for (const auto &s : segments)
+        if (!writeSectors(s.buffer, s.offset, s.numSectors))
+            return false;
+
+    return true;
+}
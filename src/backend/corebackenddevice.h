@@ -22,6 +22,7 @@
 #include "util/libpartitionmanagerexport.h"
 
 #include <QString>
+#include <QVector>
 
 class CoreBackendPartition;
 class CoreBackendPartitionTable;
@@ -35,6 +36,16 @@ class Report;
   */
 class LIBKPMCORE_EXPORT CoreBackendDevice
 {
+public:
+    /**
+      * A run of sectors on the device and the buffer to transfer it from or to.
+      */
+    struct Segment {
+        void* buffer;           /**< the data, numSectors times the sector size */
+        qint64 offset;          /**< first sector on the device */
+        qint64 numSectors;      /**< number of sectors */
+    };
+
 public:
     CoreBackendDevice(const QString& device_node);
     virtual ~CoreBackendDevice() {}
@@ -107,6 +118,33 @@ public:
       */
     virtual bool writeSectors(void* buffer, qint64 offset, qint64 numSectors) = 0;
 
+    /**
+      * Read several runs of sectors from an opened device into their buffers.
+      *
+      * Backends that can should transfer segments that follow each other on the device
+      * with a single system call. The default implementation calls readSectors() for
+      * each segment.
+      * @param segments the sectors to read and where to store them
+      * @return true on success
+      */
+    virtual bool readSegments(const QVector<Segment>& segments);
+
+    /**
+      * Write several runs of sectors from their buffers to an exclusively opened device.
+      * @see readSegments()
+      * @param segments the sectors to write and the data to write to them
+      * @return true on success
+      */
+    virtual bool writeSegments(const QVector<Segment>& segments);
+
+    /**
+      * Write everything written to an exclusively opened device to disk and drop what is
+      * cached for it, so that it and other device nodes of the disk see the same data,
+      * without closing the device.
+      * @return true on success
+      */
+    virtual bool sync() = 0;
+
 protected:
     void setExclusive(bool b) {
         m_Exclusive = b;
@@ -29,7 +29,8 @@
 #include <KServiceTypeTrader>
 
 CoreBackendManager::CoreBackendManager() :
-    m_Backend(nullptr)
+    m_Backend(nullptr),
+    m_Mutex(QMutex::Recursive)
 {
 }
 
@@ -21,6 +21,8 @@
 
 #include "util/libpartitionmanagerexport.h"
 
+#include <QMutex>
+
 #include <KService>
 
 class QString;
@@ -76,8 +78,19 @@ public:
         return m_Backend;
     }
 
+    /**
+      * Backends like libparted are not thread-safe. Code that may run in Operations running
+      * at the same time holds this (recursive) mutex while it calls into the backend or
+      * changes the preview state the backend objects were built from.
+      * @return the mutex serializing access to the backend
+      */
+    QMutex& mutex() {
+        return m_Mutex;
+    }
+
 private:
     CoreBackend* m_Backend;
+    QMutex m_Mutex;
 };
 
 #endif
@@ -0,0 +1,170 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#include "backend/devicehandlepool.h"
+
+#include "backend/corebackend.h"
+#include "backend/corebackenddevice.h"
+#include "backend/corebackendmanager.h"
+
+#include "util/globallog.h"
+
+#include <KLocalizedString>
+
+/** An exclusively opened backend device and the Job currently using it. */
+struct DeviceHandlePool::Handle
+{
+    Handle() : mutex(QMutex::Recursive), backendDevice(nullptr), users(0) {}
+
+    QMutex mutex;
+    CoreBackendDevice* backendDevice;
+    qint32 users;
+};
+
+DeviceHandlePool* DeviceHandlePool::s_Current = nullptr;
+
+/** Creates a new DeviceHandlePool.
+
+    The first pool created becomes the current one; nested pools reuse it.
+*/
+DeviceHandlePool::DeviceHandlePool() :
+    m_Owner(s_Current == nullptr),
+    m_Mutex(),
+    m_Handles(),
+    m_NumOpens(0)
+{
+    if (m_Owner)
+        s_Current = this;
+}
+
+/** Closes all devices and ends the pool. */
+DeviceHandlePool::~DeviceHandlePool()
+{
+    if (m_Owner) {
+        close();
+        s_Current = nullptr;
+    }
+
+    qDeleteAll(m_Handles);
+}
+
+/** @return the pool devices are acquired from or nullptr if there is none */
+DeviceHandlePool* DeviceHandlePool::current()
+{
+    return s_Current;
+}
+
+/** Opens a backend device in exclusive mode.
+
+    Inside a pool the device is shared with earlier and later Jobs and only opened if it is not
+    open yet. Other threads acquiring the same device wait until it has been released.
+
+    @param deviceNode the Device to open
+    @return the opened backend device or nullptr on failure; hand it back with release()
+*/
+CoreBackendDevice* DeviceHandlePool::acquire(const QString& deviceNode)
+{
+    DeviceHandlePool* pool = current();
+
+    if (pool == nullptr) {
+        QMutexLocker backendLocker(&CoreBackendManager::self()->mutex());
+        return CoreBackendManager::self()->backend()->openDeviceExclusive(deviceNode);
+    }
+
+    Handle* h = pool->handle(deviceNode);
+    h->mutex.lock();
+
+    if (h->backendDevice == nullptr) {
+        QMutexLocker backendLocker(&CoreBackendManager::self()->mutex());
+        h->backendDevice = CoreBackendManager::self()->backend()->openDeviceExclusive(deviceNode);
+
+        if (h->backendDevice == nullptr) {
+            h->mutex.unlock();
+            return nullptr;
+        }
+
+        QMutexLocker locker(&pool->m_Mutex);
+        pool->m_NumOpens++;
+    }
+
+    h->users++;
+
+    return h->backendDevice;
+}
+
+/** Hands back a backend device opened with acquire().
+
+    Inside a pool the device stays open and is synced once the last user has released it.
+    Otherwise it is closed.
+
+    @param backendDevice the device to release, may be nullptr
+    @return true if syncing the device succeeded
+*/
+bool DeviceHandlePool::release(CoreBackendDevice* backendDevice)
+{
+    if (backendDevice == nullptr)
+        return true;
+
+    DeviceHandlePool* pool = current();
+    Handle* h = pool ? pool->handle(backendDevice->deviceNode()) : nullptr;
+
+    QMutexLocker backendLocker(&CoreBackendManager::self()->mutex());
+
+    if (h == nullptr || h->backendDevice != backendDevice) {
+        delete backendDevice;
+        return true;
+    }
+
+    bool rval = true;
+
+    if (--h->users == 0 && !backendDevice->sync()) {
+        Log(Log::warning) << xi18nc("@info:status", "Could not sync device <filename>%1</filename>.", backendDevice->deviceNode());
+        rval = false;
+    }
+
+    h->mutex.unlock();
+
+    return rval;
+}
+
+/** @return the handle for a Device, created if there is none yet */
+DeviceHandlePool::Handle* DeviceHandlePool::handle(const QString& deviceNode)
+{
+    QMutexLocker locker(&m_Mutex);
+
+    Handle*& h = m_Handles[deviceNode];
+    if (h == nullptr)
+        h = new Handle;
+
+    return h;
+}
+
+/** Closes all devices, so the next acquire() opens them again. */
+void DeviceHandlePool::close()
+{
+    QMutexLocker backendLocker(&CoreBackendManager::self()->mutex());
+    QMutexLocker locker(&m_Mutex);
+
+    for (const auto &h : m_Handles) {
+        QMutexLocker handleLocker(&h->mutex);
+
+        Q_ASSERT(h->users == 0);
+
+        delete h->backendDevice;
+        h->backendDevice = nullptr;
+    }
+}
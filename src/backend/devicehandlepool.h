@@ -0,0 +1,78 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#if !defined(DEVICEHANDLEPOOL__H)
+
+#define DEVICEHANDLEPOOL__H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QtGlobal>
+
+class CoreBackendDevice;
+
+/** Keeps exclusively opened backend devices open across Jobs.
+
+    Closing a backend device that has been written to flushes and invalidates the caches of the
+    disk and all its partitions, which may take a few seconds. While a DeviceHandlePool exists,
+    acquire() hands out the same exclusively opened CoreBackendDevice to all Jobs working on a
+    Device. When a Job releases it, the device is synced (see CoreBackendDevice::sync()), so the
+    next Job, and any tool it runs on a partition device node, sees what has been written. The
+    devices are only closed when the pool is closed at the end of an OperationRunner pass.
+
+    There is at most one pool at a time; it is shared by all threads. A Job may acquire the same
+    device more than once, e.g. as source and target of a move; other Jobs wait until it has
+    released it, which matches how the OperationRunner runs Operations on a Device.
+*/
+class LIBKPMCORE_EXPORT DeviceHandlePool
+{
+    Q_DISABLE_COPY(DeviceHandlePool)
+
+    struct Handle;
+
+public:
+    DeviceHandlePool();
+    ~DeviceHandlePool();
+
+public:
+    static DeviceHandlePool* current();
+
+    static CoreBackendDevice* acquire(const QString& deviceNode);
+    static bool release(CoreBackendDevice* backendDevice);
+
+    void close();
+
+    qint32 numOpens() const {
+        return m_NumOpens;    /**< @return number of devices opened so far */
+    }
+
+protected:
+    Handle* handle(const QString& deviceNode);
+
+private:
+    bool m_Owner;
+    QMutex m_Mutex;
+    QHash<QString, Handle*> m_Handles;
+    qint32 m_NumOpens;
+
+    static DeviceHandlePool* s_Current;
+};
+
+#endif
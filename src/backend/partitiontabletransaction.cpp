@@ -0,0 +1,226 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#include "backend/partitiontabletransaction.h"
+
+#include "backend/corebackend.h"
+#include "backend/corebackenddevice.h"
+#include "backend/corebackendmanager.h"
+#include "backend/corebackendpartitiontable.h"
+
+#include "util/report.h"
+
+#include <KLocalizedString>
+
+/** The backend objects kept open for one Device and whether they hold uncommitted changes. */
+struct PartitionTableTransaction::Pending
+{
+    Pending() : backendDevice(nullptr), backendPartitionTable(nullptr), dirty(false), batch(0) {}
+
+    QMutex mutex;
+    CoreBackendDevice* backendDevice;
+    CoreBackendPartitionTable* backendPartitionTable;
+    bool dirty;
+    qint32 batch;
+};
+
+PartitionTableTransaction* PartitionTableTransaction::s_Current = nullptr;
+
+/** Opens the backend device and partition table for an edit.
+
+    Inside a transaction the backend objects of the Device are shared with earlier and later
+    edits, and other edits of the same Device wait until this one is destroyed.
+
+    @param deviceNode the Device whose partition table is to be edited
+*/
+PartitionTableTransaction::Edit::Edit(const QString& deviceNode) :
+    m_Pending(nullptr),
+    m_BackendDevice(nullptr),
+    m_BackendPartitionTable(nullptr)
+{
+    // released in the destructor, so the whole edit is serialized with other backend calls
+    CoreBackendManager::self()->mutex().lock();
+
+    PartitionTableTransaction* transaction = current();
+
+    if (transaction == nullptr) {
+        m_BackendDevice = CoreBackendManager::self()->backend()->openDevice(deviceNode);
+
+        if (m_BackendDevice)
+            m_BackendPartitionTable = m_BackendDevice->openPartitionTable();
+
+        return;
+    }
+
+    m_Pending = transaction->pending(deviceNode);
+    m_Pending->mutex.lock();
+
+    if (m_Pending->backendPartitionTable == nullptr) {
+        delete m_Pending->backendDevice;
+        m_Pending->backendDevice = CoreBackendManager::self()->backend()->openDevice(deviceNode);
+
+        if (m_Pending->backendDevice)
+            m_Pending->backendPartitionTable = m_Pending->backendDevice->openPartitionTable();
+    }
+
+    m_BackendDevice = m_Pending->backendDevice;
+    m_BackendPartitionTable = m_Pending->backendPartitionTable;
+}
+
+/** Closes the backend objects, or hands them back to the transaction. */
+PartitionTableTransaction::Edit::~Edit()
+{
+    if (m_Pending)
+        m_Pending->mutex.unlock();
+    else {
+        delete m_BackendPartitionTable;
+        delete m_BackendDevice;
+    }
+
+    CoreBackendManager::self()->mutex().unlock();
+}
+
+/** Commits the changes made in this edit.
+
+    Inside a transaction the partition table is only marked as changed and written when the
+    transaction is committed.
+
+    @return true on success
+*/
+bool PartitionTableTransaction::Edit::commit()
+{
+    if (m_BackendPartitionTable == nullptr)
+        return false;
+
+    if (m_Pending) {
+        m_Pending->dirty = true;
+        return true;
+    }
+
+    return m_BackendPartitionTable->commit();
+}
+
+/** Creates a new PartitionTableTransaction.
+
+    The first transaction created becomes the current one; nested transactions reuse it.
+*/
+PartitionTableTransaction::PartitionTableTransaction() :
+    m_Owner(s_Current == nullptr),
+    m_Mutex(),
+    m_Pending(),
+    m_NumCommits(0)
+{
+    if (m_Owner)
+        s_Current = this;
+}
+
+/** Commits all outstanding changes and ends the transaction. */
+PartitionTableTransaction::~PartitionTableTransaction()
+{
+    if (m_Owner) {
+        commit();
+        s_Current = nullptr;
+    }
+
+    qDeleteAll(m_Pending);
+}
+
+/** @return the transaction partition table edits take part in or nullptr if there is none */
+PartitionTableTransaction* PartitionTableTransaction::current()
+{
+    return s_Current;
+}
+
+/** @return the backend objects for a Device, created if there are none yet */
+PartitionTableTransaction::Pending* PartitionTableTransaction::pending(const QString& deviceNode)
+{
+    QMutexLocker locker(&m_Mutex);
+
+    Pending*& p = m_Pending[deviceNode];
+    if (p == nullptr)
+        p = new Pending;
+
+    return p;
+}
+
+/** Finds out if a Device has edits that have not been committed yet.
+    @param deviceNode the Device to look at
+    @param batch set to a number identifying the commit the edits will be part of, if not nullptr
+    @return true if there are uncommitted edits
+*/
+bool PartitionTableTransaction::hasPendingEdits(const QString& deviceNode, qint32* batch)
+{
+    QMutexLocker locker(&m_Mutex);
+
+    Pending* p = m_Pending.value(deviceNode);
+    if (p == nullptr)
+        return false;
+
+    QMutexLocker pendingLocker(&p->mutex);
+
+    if (batch)
+        *batch = p->batch;
+
+    return p->dirty;
+}
+
+/** Commits all changed partition tables and closes all backend objects, so the next edit
+    starts from what is on disk.
+
+    A failed commit is reported, but the edits cannot be undone: the Jobs that made them have
+    already succeeded. The caller has to fail whatever depended on them.
+
+    @param report the Report to write failures to, if any
+    @param failedDevices the device nodes whose commit failed are appended to this, if not nullptr
+    @return true if all commits succeeded
+*/
+bool PartitionTableTransaction::commit(Report* report, QStringList* failedDevices)
+{
+    bool rval = true;
+
+    QMutexLocker backendLocker(&CoreBackendManager::self()->mutex());
+    QMutexLocker locker(&m_Mutex);
+
+    for (auto it = m_Pending.begin(); it != m_Pending.end(); ++it) {
+        Pending* p = it.value();
+        QMutexLocker pendingLocker(&p->mutex);
+
+        if (p->dirty && p->backendPartitionTable) {
+            m_NumCommits++;
+            p->batch++;
+
+            if (!p->backendPartitionTable->commit()) {
+                rval = false;
+
+                if (failedDevices)
+                    failedDevices->append(it.key());
+
+                if (report)
+                    report->line() << xi18nc("@info:progress", "Could not commit the changes to the partition table on device <filename>%1</filename>.", it.key());
+            }
+        }
+
+        delete p->backendPartitionTable;
+        delete p->backendDevice;
+
+        p->backendPartitionTable = nullptr;
+        p->backendDevice = nullptr;
+        p->dirty = false;
+    }
+
+    return rval;
+}
@@ -0,0 +1,106 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#if !defined(PARTITIONTABLETRANSACTION__H)
+
+#define PARTITIONTABLETRANSACTION__H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+class CoreBackendDevice;
+class CoreBackendPartitionTable;
+class Report;
+
+/** Groups partition table edits on a Device into a single commit.
+
+    Committing a partition table writes it to disk, makes the kernel re-read it and waits for udev
+    to settle. While a PartitionTableTransaction exists, Jobs that edit a partition table through
+    an Edit keep the backend partition table of their Device open and only mark it as changed. All
+    changed tables are committed in one go when commit() is called, which happens before any Job
+    that needs the partition device nodes to be up to date and when the transaction ends.
+
+    There is at most one transaction at a time; it is shared by all threads. An Edit and a commit
+    hold CoreBackendManager::mutex(), so they are serialized with all other backend calls.
+
+    @see Job::needsDeviceNodes()
+*/
+class LIBKPMCORE_EXPORT PartitionTableTransaction
+{
+    Q_DISABLE_COPY(PartitionTableTransaction)
+
+    struct Pending;
+
+public:
+    /** Access to the backend partition table of one Device for the duration of a Job. */
+    class LIBKPMCORE_EXPORT Edit
+    {
+        Q_DISABLE_COPY(Edit)
+
+    public:
+        explicit Edit(const QString& deviceNode);
+        ~Edit();
+
+    public:
+        CoreBackendDevice* backendDevice() const {
+            return m_BackendDevice;    /**< @return the opened backend device or nullptr on failure */
+        }
+        CoreBackendPartitionTable* backendPartitionTable() const {
+            return m_BackendPartitionTable;    /**< @return the opened backend partition table or nullptr on failure */
+        }
+
+        bool commit();
+
+    private:
+        Pending* m_Pending;
+        CoreBackendDevice* m_BackendDevice;
+        CoreBackendPartitionTable* m_BackendPartitionTable;
+    };
+
+public:
+    PartitionTableTransaction();
+    ~PartitionTableTransaction();
+
+public:
+    static PartitionTableTransaction* current();
+
+    bool commit(Report* report = nullptr, QStringList* failedDevices = nullptr);
+
+    bool hasPendingEdits(const QString& deviceNode, qint32* batch = nullptr);
+
+    qint32 numCommits() const {
+        return m_NumCommits;    /**< @return number of partition table commits done so far */
+    }
+
+protected:
+    Pending* pending(const QString& deviceNode);
+
+private:
+    bool m_Owner;
+    QMutex m_Mutex;
+    QHash<QString, Pending*> m_Pending;
+    qint32 m_NumCommits;
+
+    static PartitionTableTransaction* s_Current;
+};
+
+#endif
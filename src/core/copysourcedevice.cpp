@@ -18,9 +18,8 @@
 
 #include "core/copysourcedevice.h"
 
-#include "backend/corebackend.h"
-#include "backend/corebackendmanager.h"
 #include "backend/corebackenddevice.h"
+#include "backend/devicehandlepool.h"
 
 #include "core/copytarget.h"
 #include "core/copytargetdevice.h"
@@ -43,7 +42,7 @@ CopySourceDevice::CopySourceDevice(Device& d, qint64 firstsector, qint64 lastsec
 /** Destructs a CopySourceDevice */
 CopySourceDevice::~CopySourceDevice()
 {
-    delete m_BackendDevice;
+    DeviceHandlePool::release(m_BackendDevice);
 }
 
 /** Opens the Device
@@ -51,7 +50,7 @@ CopySourceDevice::~CopySourceDevice()
 */
 bool CopySourceDevice::open()
 {
-    m_BackendDevice = CoreBackendManager::self()->backend()->openDeviceExclusive(device().deviceNode());
+    m_BackendDevice = DeviceHandlePool::acquire(device().deviceNode());
     return m_BackendDevice != nullptr;
 }
 
@@ -17,9 +17,8 @@
 
 #include "core/copytargetdevice.h"
 
-#include "backend/corebackend.h"
-#include "backend/corebackendmanager.h"
 #include "backend/corebackenddevice.h"
+#include "backend/devicehandlepool.h"
 
 #include "core/device.h"
 
@@ -41,7 +40,7 @@ CopyTargetDevice::CopyTargetDevice(Device& d, qint64 firstsector, qint64 lastsec
 /** Destructs a CopyTargetDevice */
 CopyTargetDevice::~CopyTargetDevice()
 {
-    delete m_BackendDevice;
+    DeviceHandlePool::release(m_BackendDevice);
 }
 
 /** Opens a CopyTargetDevice for writing to.
@@ -49,7 +48,7 @@ CopyTargetDevice::~CopyTargetDevice()
 */
 bool CopyTargetDevice::open()
 {
-    m_BackendDevice = CoreBackendManager::self()->backend()->openDeviceExclusive(device().deviceNode());
+    m_BackendDevice = DeviceHandlePool::acquire(device().deviceNode());
     return m_BackendDevice != nullptr;
 }
 
@@ -26,9 +26,12 @@
 #include "core/lvmdevice.h"
 #include "core/diskdevice.h"
 
+#include "fs/filesystemfactory.h"
 #include "fs/lvm2_pv.h"
 
 #include "util/externalcommand.h"
+#include "util/lvmcommandsession.h"
+
 #include <QRegularExpression>
 #include <QDebug>
 
@@ -62,11 +65,20 @@ void DeviceScanner::scan()
 {
     emit progress(QString(), 0);
 
+    // file system tools have only been looked up in PATH so far, make sure they actually run
+    FileSystemFactory::verifyTools();
+
     clear();
 
+    // all LVM queries of this scan share a single lvm process
+    LvmCommandSession lvmSession;
+
+    // repeated read-only queries (lsblk, pvs, luksDump...) are only run once per scan
+    ExternalCommand::CachedScan cachedScan;
+
     const QList<Device*> deviceList = CoreBackendManager::self()->backend()->scanDevices();
     const QList<LvmDevice*> lvmList = LvmDevice::scanSystemLVM(); // NOTE: PVs inside LVM won't be scanned
-    operationStack().physicalVolumes() = FS::lvm2_pv::getPVs(deviceList);
+    operationStack().setPhysicalVolumes(FS::lvm2_pv::getPVs(deviceList));
 
     for (const auto &d : deviceList)
         operationStack().addDevice(d);
@@ -75,8 +87,7 @@ void DeviceScanner::scan()
 
     for (const auto &d : lvmList) {
         operationStack().addDevice(d);
-        operationStack().physicalVolumes().append(FS::lvm2_pv::getPVinNode(d->partitionTable()));
+        operationStack().addPhysicalVolumes(FS::lvm2_pv::getPVinNode(d->partitionTable()));
     }
-
 }
 
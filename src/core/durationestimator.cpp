@@ -0,0 +1,332 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#include "core/durationestimator.h"
+
+#include "core/device.h"
+#include "core/lvmdevice.h"
+#include "core/partition.h"
+
+#include "fs/filesystem.h"
+
+#include "jobs/job.h"
+
+#include "ops/operation.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSettings>
+#include <QStandardPaths>
+
+namespace
+{
+/** Throughput assumed for Devices that have not been measured yet, in bytes per second */
+const qint64 defaultThroughput = 100 * 1024 * 1024;
+
+/** Runs shorter than this are dominated by seek times and startup costs and are not learned from */
+const qint64 minLearnBytes = 64 * 1024 * 1024;
+
+/** Weight of a new measurement in the moving average */
+const double learnRate = 0.3;
+
+const qint64 gib = 1024 * 1024 * 1024;
+
+/** Time an external tool takes to start up and do its basic work, regardless of the data size */
+const qint64 toolOverhead = 2000;
+
+/** Default costs of the external tools in milliseconds per GiB, indexed by DurationEstimator::Tool */
+const qint64 defaultToolCost[] = { 4000, 3000, 500 };
+
+const char* const toolNames[] = { "check", "resize", "create" };
+
+QMutex settingsMutex;
+
+QString settingsFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/kpmcore/durations.ini");
+}
+
+QString readSysfs(const QString& path)
+{
+    QFile f(path);
+
+    if (!f.open(QIODevice::ReadOnly))
+        return QString();
+
+    return QString::fromLocal8Bit(f.readAll()).trimmed();
+}
+
+/** Finds something that identifies a Device across reboots, unlike its device node.
+
+    Disks are known by their model and the WWID or serial number the kernel reports, or else by
+    their link in /dev/disk/by-id. Loop devices are known by their backing file and volume groups
+    by their UUID. Image files have no such thing, but their path does not change.
+
+    @param d the Device
+    @return the identity of the Device
+*/
+QString deviceIdentity(const Device& d)
+{
+    if (d.type() == Device::LVM_Device)
+        return QStringLiteral("lvm:") + static_cast<const LvmDevice&>(d).UUID();
+
+    const QString node = QFileInfo(d.deviceNode()).canonicalFilePath();
+    if (node.isEmpty())
+        return d.deviceNode();
+
+    const QString sysfs = QStringLiteral("/sys/class/block/%1/").arg(QFileInfo(node).fileName());
+
+    for (const auto &attribute : { QStringLiteral("wwid"), QStringLiteral("device/wwid"), QStringLiteral("device/serial"), QStringLiteral("loop/backing_file") }) {
+        const QString id = readSysfs(sysfs + attribute);
+        if (!id.isEmpty())
+            return d.name() + QLatin1Char('\0') + id;
+    }
+
+    // links for LVM physical volumes come and go with their contents, leave them out
+    QDir byId(QStringLiteral("/dev/disk/by-id"));
+    for (const auto &link : byId.entryList(QDir::System | QDir::NoDotAndDotDot, QDir::Name))
+        if (!link.startsWith(QStringLiteral("lvm-pv-uuid-")) && QFileInfo(byId.filePath(link)).canonicalFilePath() == node)
+            return link;
+
+    return node;
+}
+
+QString deviceKey(const QString& direction, const Device& d)
+{
+    return direction + QLatin1Char('/') +
+           QString::fromLatin1(QCryptographicHash::hash(deviceIdentity(d).toUtf8(), QCryptographicHash::Sha1).toHex());
+}
+
+QString toolKey(DurationEstimator::Tool tool, FileSystem::Type type)
+{
+    return QStringLiteral("tool/") + QLatin1String(toolNames[tool]) + QLatin1Char('/') + QString::number(type);
+}
+
+/** Creating a file system takes time by its size, checking and resizing by the data on it */
+qint64 toolDataSize(DurationEstimator::Tool tool, const Partition& p)
+{
+    if (tool == DurationEstimator::Create || p.used() < 0)
+        return p.capacity();
+
+    return p.used();
+}
+
+qint64 throughput(const QString& direction, const Device* d)
+{
+    if (d == nullptr)
+        return defaultThroughput;
+
+    QMutexLocker locker(&settingsMutex);
+    QSettings settings(settingsFileName(), QSettings::IniFormat);
+    const qint64 rval = settings.value(deviceKey(direction, *d), defaultThroughput).toLongLong();
+
+    return rval > 0 ? rval : defaultThroughput;
+}
+
+void learn(QSettings& settings, const QString& key, qint64 measured)
+{
+    const qint64 old = settings.value(key, -1).toLongLong();
+    settings.setValue(key, old < 0 ? measured : qint64(old * (1 - learnRate) + measured * learnRate));
+}
+}
+
+/** Creates a new DurationEstimator following the given Operations while they run.
+    @param ops the Operations to follow, in the order they are numbered in operationFinished()
+    @param parent the parent object
+*/
+DurationEstimator::DurationEstimator(const QList<Operation*>& ops, QObject* parent) :
+    QObject(parent),
+    m_States(ops.size()),
+    m_LastChange(),
+    m_Mutex()
+{
+    for (int i = 0; i < ops.size(); i++) {
+        OperationState& state = m_States[i];
+        state.currentJob = -1;
+        state.progress = 0;
+        state.finished = false;
+
+        for (const auto &job : ops[i]->jobs()) {
+            state.jobDurations.append(job->estimatedDuration());
+            state.jobSteps.append(job->numSteps());
+        }
+
+        // jobs run in the thread of their operation, so update directly and lock
+        connect(ops[i], &Operation::jobStarted, this, [this, i] (Job*, Operation*) { onJobStarted(i); }, Qt::DirectConnection);
+        connect(ops[i], &Operation::progress, this, [this, i] (int progress) { onProgress(i, progress); }, Qt::DirectConnection);
+    }
+
+    m_LastChange.start();
+}
+
+/** @return for each Operation the predicted time in milliseconds until it has finished, 0 if it has finished */
+QVector<qint64> DurationEstimator::timeLeft() const
+{
+    QMutexLocker locker(&m_Mutex);
+
+    QVector<qint64> rval(m_States.size(), 0);
+
+    for (int i = 0; i < m_States.size(); i++) {
+        const OperationState& state = m_States[i];
+
+        if (state.finished)
+            continue;
+
+        for (int j = state.currentJob + 1; j < state.jobDurations.size(); j++)
+            rval[i] += state.jobDurations[j];
+
+        if (state.currentJob >= 0) {
+            const qint64 elapsed = state.timer.elapsed();
+            const qint32 steps = state.jobSteps[state.currentJob];
+
+            // extrapolate once the job tells us how far it has got, else trust the prediction
+            if (state.progress > 0 && steps > 0)
+                rval[i] += elapsed * qMax(0, steps - state.progress) / state.progress;
+            else
+                rval[i] += qMax(Q_INT64_C(0), state.jobDurations[state.currentJob] - elapsed);
+        }
+    }
+
+    return rval;
+}
+
+/** Marks an Operation as finished, whether its Jobs all ran or not.
+    @param op the index of the Operation
+*/
+void DurationEstimator::operationFinished(qint32 op)
+{
+    {
+        QMutexLocker locker(&m_Mutex);
+        m_States[op].finished = true;
+    }
+
+    emit changed();
+}
+
+void DurationEstimator::onJobStarted(qint32 op)
+{
+    {
+        QMutexLocker locker(&m_Mutex);
+        OperationState& state = m_States[op];
+
+        state.currentJob = qMin(state.currentJob + 1, state.jobDurations.size() - 1);
+        state.progress = 0;
+        state.timer.start();
+    }
+
+    emit changed();
+}
+
+void DurationEstimator::onProgress(qint32 op, int progress)
+{
+    {
+        QMutexLocker locker(&m_Mutex);
+        m_States[op].progress = progress;
+
+        // progress can be reported many times a second, don't flood the receivers
+        if (m_LastChange.elapsed() < 500)
+            return;
+
+        m_LastChange.restart();
+    }
+
+    emit changed();
+}
+
+/** @param op the Operation to look at
+    @return the predicted run time of all of the Operation's Jobs in milliseconds
+*/
+qint64 DurationEstimator::estimate(const Operation& op)
+{
+    qint64 rval = 0;
+
+    for (const auto &job : op.jobs())
+        rval += job->estimatedDuration();
+
+    return rval;
+}
+
+/** Predicts how long copying data block by block takes.
+
+    Blocks are read and then written one after the other, so the read and write times add up.
+
+    @param source the Device read from, nullptr if not reading from a Device
+    @param target the Device written to, nullptr if not writing to a Device
+    @param bytes the number of bytes to copy
+    @return the predicted duration in milliseconds
+*/
+qint64 DurationEstimator::copyDuration(const Device* source, const Device* target, qint64 bytes)
+{
+    return bytes * 1000 / throughput(QStringLiteral("read"), source) + bytes * 1000 / throughput(QStringLiteral("write"), target);
+}
+
+/** Predicts how long an external file system tool runs.
+    @param tool the kind of tool
+    @param p the Partition with the FileSystem the tool works on
+    @return the predicted duration in milliseconds
+*/
+qint64 DurationEstimator::toolDuration(Tool tool, const Partition& p)
+{
+    QMutexLocker locker(&settingsMutex);
+    QSettings settings(settingsFileName(), QSettings::IniFormat);
+    const qint64 costPerGiB = settings.value(toolKey(tool, p.fileSystem().type()), defaultToolCost[tool]).toLongLong();
+
+    return toolOverhead + toolDataSize(tool, p) * costPerGiB / gib;
+}
+
+/** Learns the throughput of Devices from a finished copy.
+    @param source the Device read from, nullptr if the source was not a Device
+    @param readMsecs the time spent reading in milliseconds
+    @param target the Device written to, nullptr if the target was not a Device
+    @param writeMsecs the time spent writing in milliseconds
+    @param bytes the number of bytes copied
+*/
+void DurationEstimator::recordCopy(const Device* source, qint64 readMsecs, const Device* target, qint64 writeMsecs, qint64 bytes)
+{
+    if (bytes < minLearnBytes)
+        return;
+
+    QMutexLocker locker(&settingsMutex);
+    QSettings settings(settingsFileName(), QSettings::IniFormat);
+
+    if (source && readMsecs > 0)
+        learn(settings, deviceKey(QStringLiteral("read"), *source), bytes * 1000 / readMsecs);
+
+    if (target && writeMsecs > 0)
+        learn(settings, deviceKey(QStringLiteral("write"), *target), bytes * 1000 / writeMsecs);
+}
+
+/** Learns the cost of an external file system tool from a finished run.
+    @param tool the kind of tool
+    @param p the Partition with the FileSystem the tool worked on
+    @param msecs the time the tool took in milliseconds
+*/
+void DurationEstimator::recordTool(Tool tool, const Partition& p, qint64 msecs)
+{
+    const qint64 bytes = toolDataSize(tool, p);
+
+    if (bytes < minLearnBytes)
+        return;
+
+    QMutexLocker locker(&settingsMutex);
+    QSettings settings(settingsFileName(), QSettings::IniFormat);
+
+    learn(settings, toolKey(tool, p.fileSystem().type()), qMax(Q_INT64_C(0), msecs - toolOverhead) * gib / bytes);
+}
@@ -0,0 +1,97 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#if !defined(DURATIONESTIMATOR__H)
+
+#define DURATIONESTIMATOR__H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+#include <QtGlobal>
+
+class Device;
+class Partition;
+class Operation;
+
+/** Predicts how long Operations will take to run.
+
+    Jobs copying data predict their duration from the sequential read and write throughput of
+    the Devices involved; Jobs running external file system tools from a per-tool cost in
+    milliseconds per GiB. Both are learned from previous runs and stored persistently, so the
+    predictions get better the more a Device or tool is used.
+
+    While Operations are running, a DurationEstimator follows their Jobs' progress and
+    extrapolates the time left for the running Job from the time it has taken so far.
+
+    @author Andrius Štikonas <andrius@stikonas.eu>
+*/
+class LIBKPMCORE_EXPORT DurationEstimator : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(DurationEstimator)
+
+public:
+    /** External tools with a learned cost model */
+    enum Tool {
+        Check = 0,      /**< check and repair a file system */
+        Resize,         /**< resize a file system */
+        Create          /**< create a file system */
+    };
+
+public:
+    DurationEstimator(const QList<Operation*>& ops, QObject* parent = nullptr);
+
+Q_SIGNALS:
+    void changed();
+
+public:
+    QVector<qint64> timeLeft() const;
+    void operationFinished(qint32 op);
+
+    static qint64 estimate(const Operation& op);
+    static qint64 copyDuration(const Device* source, const Device* target, qint64 bytes);
+    static qint64 toolDuration(Tool tool, const Partition& p);
+
+    static void recordCopy(const Device* source, qint64 readMsecs, const Device* target, qint64 writeMsecs, qint64 bytes);
+    static void recordTool(Tool tool, const Partition& p, qint64 msecs);
+
+protected:
+    void onJobStarted(qint32 op);
+    void onProgress(qint32 op, int progress);
+
+private:
+    /** What is known about a running or pending Operation */
+    struct OperationState {
+        QList<qint64> jobDurations;
+        QList<qint32> jobSteps;
+        qint32 currentJob;
+        qint32 progress;
+        QElapsedTimer timer;
+        bool finished;
+    };
+
+    QVector<OperationState> m_States;
+    QElapsedTimer m_LastChange;
+    mutable QMutex m_Mutex;
+};
+
+#endif
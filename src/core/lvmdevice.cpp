@@ -25,9 +25,14 @@
 #include "core/partitiontable.h"
 #include "util/externalcommand.h"
 #include "util/helpers.h"
+#include "util/lvmcommandsession.h"
 #include "util/report.h"
 
 #include <QRegularExpression>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
 #include <QtMath>
 
 #include <KDiskFreeSpaceInfo>
@@ -53,6 +58,7 @@ LvmDevice::LvmDevice(const QString& vgName, const QString& iconName)
     m_UUID    = getUUID(vgName);
     m_LVPathList = new QStringList(getLVs(vgName));
     m_LVSizeMap  = new QMap<QString, qint64>();
+    m_LVOffsets.append(0);
 
     initPartitions();
 }
@@ -75,75 +81,117 @@ void LvmDevice::initPartitions()
     qint64 lastusable  = totalPE() - 1;
     PartitionTable* pTable = new PartitionTable(PartitionTable::vmd, firstUsable, lastusable);
 
-    for (const auto &p : scanPartitions(pTable)) {
-        LVSizeMap()->insert(p->partitionPath(), p->length());
+    for (const auto &p : scanPartitions(pTable))
         pTable->append(p);
-    }
 
     pTable->updateUnallocated(*this);
 
     setPartitionTable(pTable);
 }
 
-/**
- *  @return a initialized Partition(LV) list
+namespace
+{
+/** Splits a list of paths so that each part still fits on an lvm shell command line.
+ *
+ *  @param paths the paths to split
+ *  @param fixedArgs the number of other arguments on the command line, the lvm command included
+ *  @return the parts, in the order of @p paths
  */
-const QList<Partition*> LvmDevice::scanPartitions(PartitionTable* pTable) const
+QList<QStringList> splitForLvmShell(const QStringList& paths, qint32 fixedArgs)
 {
-    QList<Partition*> pList;
-    for (const auto &lvPath : partitionNodes()) {
-        pList.append(scanPartition(lvPath, pTable));
+    const qint32 size = LvmCommandSession::maxArguments - 1 - fixedArgs;
+
+    QList<QStringList> parts;
+    for (qint32 i = 0; i < paths.size(); i += size)
+        parts.append(paths.mid(i, size));
+
+    return parts;
+}
+
+/** Finds out which of some PVs belong to a VG.
+ *
+ *  @param vgName the VG
+ *  @param pvList paths of the PVs to look for
+ *  @param ok set to false if membership could not be queried
+ *  @return the PVs from @p pvList that are in the VG, in the order of @p pvList
+ */
+QStringList membersOf(const QString& vgName, const QStringList& pvList, bool& ok)
+{
+    ExternalCommand pvs(QStringLiteral("lvm"),
+            { QStringLiteral("pvs"),
+              QStringLiteral("--foreign"),
+              QStringLiteral("--readonly"),
+              QStringLiteral("--noheadings"),
+              QStringLiteral("--separator"),
+              QStringLiteral(":"),
+              QStringLiteral("--options"),
+              QStringLiteral("pv_name,vg_name") });
+
+    ok = pvs.run(-1) && pvs.exitCode() == 0;
+    if (!ok)
+        return QStringList();
+
+    QStringList members;
+    for (const auto &line : pvs.output().split(QStringLiteral("\n"), QString::SkipEmptyParts)) {
+        const QStringList fields = line.trimmed().split(QStringLiteral(":"));
+        if (fields.size() >= 2 && fields[1] == vgName)
+            members.append(fields[0]);
     }
-    return pList;
+
+    QStringList rval;
+    for (const auto &pvPath : pvList)
+        if (members.contains(pvPath))
+            rval.append(pvPath);
+
+    return rval;
 }
 
-/** scan and construct a partition(LV) at a given path
+/** Everything that is found out about a LV before it is turned into a Partition */
+struct LvProbe
+{
+    QString lvPath;
+    qint64 lvSize = -1;
+    FileSystem* fs = nullptr;
+    PartitionRole::Roles roles = PartitionRole::Lvm_Lv;
+    QString mountPoint;
+    bool mounted = false;
+};
+
+/** Detect size, file system, mount status, label, UUID and usage of a LV.
  *
- * NOTE:
- * LVM partition has 2 different start and end sector values
- * 1. representing the actual LV start from 0 -> size of LV - 1
- * 2. representing abstract LV's sector inside a VG partitionTable
- *    start from last sector + 1 of last Partitions -> size of LV - 1
- * Reason for this is for the LV Partition to work nicely with other parts of the codebase
- * without too many special cases.
+ *  This only runs external commands and creates a FileSystem, so it is safe to run
+ *  for several LVs in parallel.
  *
- * @param lvPath LVM Logical Volume path
- * @param pTable Abstract partition table representing partitions of LVM Volume Group
- * @return initialized Partition(LV)
+ *  @param probe the probe to fill in, lvPath must be set
+ *  @param sectorSize the VG's logical sector size (PE size) in bytes
  */
-Partition* LvmDevice::scanPartition(const QString& lvPath, PartitionTable* pTable) const
+void probeLV(LvProbe& probe, qint64 sectorSize)
 {
-    activateLV(lvPath);
+    const QString& lvPath = probe.lvPath;
 
-    qint64 lvSize = getTotalLE(lvPath);
-    qint64 startSector = mappedSector(lvPath, 0);
-    qint64 endSector = startSector + lvSize - 1;
+    probe.lvSize = LvmDevice::getTotalLE(lvPath);
 
     FileSystem::Type type = FileSystem::detectFileSystem(lvPath);
-    FileSystem* fs = FileSystemFactory::create(type, 0, lvSize - 1);
+    FileSystem* fs = FileSystemFactory::create(type, 0, probe.lvSize - 1);
     fs->scan(lvPath);
 
-    PartitionRole::Roles r = PartitionRole::Lvm_Lv;
-    QString mountPoint;
-    bool mounted;
-
     // Handle LUKS partition
     if (fs->type() == FileSystem::Luks) {
-        r |= PartitionRole::Luks;
+        probe.roles |= PartitionRole::Luks;
         FS::luks::initLUKS(fs);
         QString mapperNode = static_cast<FS::luks*>(fs)->mapperName();
-        mountPoint = FileSystem::detectMountPoint(fs, mapperNode);
-        mounted    = FileSystem::detectMountStatus(fs, mapperNode);
+        probe.mountPoint = FileSystem::detectMountPoint(fs, mapperNode);
+        probe.mounted    = FileSystem::detectMountStatus(fs, mapperNode);
     } else {
-        mountPoint = FileSystem::detectMountPoint(fs, lvPath);
-        mounted = FileSystem::detectMountStatus(fs, lvPath);
+        probe.mountPoint = FileSystem::detectMountPoint(fs, lvPath);
+        probe.mounted = FileSystem::detectMountStatus(fs, lvPath);
 
-        const KDiskFreeSpaceInfo freeSpaceInfo = KDiskFreeSpaceInfo::freeSpaceInfo(mountPoint);
-        if (logicalSize() > 0 && fs->type() != FileSystem::Luks) {
-            if (mounted && freeSpaceInfo.isValid() && mountPoint != QString()) {
-                fs->setSectorsUsed(freeSpaceInfo.used() / logicalSize());
+        const KDiskFreeSpaceInfo freeSpaceInfo = KDiskFreeSpaceInfo::freeSpaceInfo(probe.mountPoint);
+        if (sectorSize > 0 && fs->type() != FileSystem::Luks) {
+            if (probe.mounted && freeSpaceInfo.isValid() && probe.mountPoint != QString()) {
+                fs->setSectorsUsed(freeSpaceInfo.used() / sectorSize);
             } else if (fs->supportGetUsed() == FileSystem::cmdSupportFileSystem) {
-                fs->setSectorsUsed(qCeil(fs->readUsedCapacity(lvPath) / static_cast<float>(logicalSize())));
+                fs->setSectorsUsed(qCeil(fs->readUsedCapacity(lvPath) / static_cast<float>(sectorSize)));
             }
         }
    }
@@ -154,17 +202,83 @@ Partition* LvmDevice::scanPartition(const QString& lvPath, PartitionTable* pTabl
     if (fs->supportGetUUID() != FileSystem::cmdSupportNone)
         fs->setUUID(fs->readUUID(lvPath));
 
-    Partition* part = new Partition(pTable,
+    probe.fs = fs;
+}
+
+class LvProbeRunnable : public QRunnable
+{
+public:
+    LvProbeRunnable(LvProbe& probe, qint64 sectorSize) :
+        m_Probe(probe),
+        m_SectorSize(sectorSize)
+    {
+    }
+
+    void run() override {
+        probeLV(m_Probe, m_SectorSize);
+    }
+
+private:
+    LvProbe& m_Probe;
+    qint64 m_SectorSize;
+};
+}
+
+/**
+ *  All LVs are activated with as few lvm commands as possible, then probed in parallel on a thread pool.
+ *  Partitions are created afterwards in the calling thread, in the order of partitionNodes().
+ *
+ *  NOTE:
+ *  LVM partition has 2 different start and end sector values
+ *  1. representing the actual LV start from 0 -> size of LV - 1
+ *  2. representing abstract LV's sector inside a VG partitionTable
+ *     start from last sector + 1 of last Partitions -> size of LV - 1
+ *  Reason for this is for the LV Partition to work nicely with other parts of the codebase
+ *  without too many special cases.
+ *
+ *  @return a initialized Partition(LV) list
+ */
+const QList<Partition*> LvmDevice::scanPartitions(PartitionTable* pTable) const
+{
+    const QStringList lvPathList = partitionNodes();
+
+    QList<Partition*> pList;
+    if (lvPathList.isEmpty())
+        return pList;
+
+    activateLVs(lvPathList);
+
+    QVector<LvProbe> probes(lvPathList.size());
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+    for (int i = 0; i < lvPathList.size(); i++) {
+        probes[i].lvPath = lvPathList[i];
+        pool.start(new LvProbeRunnable(probes[i], logicalSize()));
+    }
+    pool.waitForDone();
+
+    for (int i = 0; i < probes.size(); i++) {
+        const LvProbe& probe = probes.at(i);
+
+        addToLayout(probe.lvPath, probe.lvSize);
+
+        qint64 startSector = mappedSector(probe.lvPath, 0);
+        qint64 endSector = startSector + probe.lvSize - 1;
+
+        pList.append(new Partition(pTable,
                     *this,
-                    PartitionRole(r),
-                    fs,
+                    PartitionRole(probe.roles),
+                    probe.fs,
                     startSector,
                     endSector,
-                    lvPath,
+                    probe.lvPath,
                     PartitionTable::Flag::FlagNone,
-                    mountPoint,
-                    mounted);
-    return part;
+                    probe.mountPoint,
+                    probe.mounted));
+    }
+
+    return pList;
 }
 
 /** scan and contruct list of initialized LvmDevice objects.
@@ -182,17 +296,80 @@ QList<LvmDevice*> LvmDevice::scanSystemLVM()
 
 qint64 LvmDevice::mappedSector(const QString& lvPath, qint64 sector) const
 {
-    qint64 mSector = 0;
-    QList<QString> lvpathList = partitionNodes();
-    qint32 devIndex = lvpathList.indexOf(lvPath);
+    const qint32 devIndex = m_LVIndex.value(lvPath, -1);
 
-    if (devIndex) {
-        for (int i = 0; i < devIndex; i++) {
-            mSector += LVSizeMap()->value(lvpathList[i]);
-        }
-        mSector += sector;
+    if (devIndex < 0)
+        return sector;
+
+    return m_LVOffsets[devIndex] + sector;
+}
+
+/** Append a LV to the abstract VG partition table layout
+ *
+ *  @param lvPath LVM Logical Volume path
+ *  @param size size of the LV in extents
+ */
+void LvmDevice::addToLayout(const QString& lvPath, qint64 size) const
+{
+    if (m_LVIndex.contains(lvPath)) {
+        resizeInLayout(lvPath, size);
+        return;
     }
-    return mSector;
+
+    if (!LVPathList()->contains(lvPath))
+        LVPathList()->append(lvPath);
+
+    LVSizeMap()->insert(lvPath, size);
+
+    m_LVIndex.insert(lvPath, m_LVOffsets.size() - 1);
+    m_LVOffsets.append(m_LVOffsets.last() + size);
+}
+
+/** Remove a LV from the abstract VG partition table layout, moving all following LVs down
+ *
+ *  @param lvPath LVM Logical Volume path
+ */
+void LvmDevice::removeFromLayout(const QString& lvPath) const
+{
+    const qint32 devIndex = m_LVIndex.value(lvPath, -1);
+
+    if (devIndex < 0)
+        return;
+
+    const qint64 size = m_LVOffsets[devIndex + 1] - m_LVOffsets[devIndex];
+    for (int i = devIndex + 1; i < m_LVOffsets.size(); i++)
+        m_LVOffsets[i] -= size;
+    m_LVOffsets.remove(devIndex + 1);
+
+    m_LVIndex.remove(lvPath);
+    LVSizeMap()->remove(lvPath);
+    LVPathList()->removeAll(lvPath);
+
+    for (int i = devIndex; i < LVPathList()->size(); i++)
+        if (m_LVIndex.contains(LVPathList()->at(i)))
+            m_LVIndex[LVPathList()->at(i)] = i;
+}
+
+/** Update the size of a LV in the abstract VG partition table layout
+ *
+ *  @param lvPath LVM Logical Volume path
+ *  @param size new size of the LV in extents
+ */
+void LvmDevice::resizeInLayout(const QString& lvPath, qint64 size) const
+{
+    const qint32 devIndex = m_LVIndex.value(lvPath, -1);
+
+    if (devIndex < 0) {
+        addToLayout(lvPath, size);
+        return;
+    }
+
+    const qint64 delta = size - (m_LVOffsets[devIndex + 1] - m_LVOffsets[devIndex]);
+    if (delta != 0)
+        for (int i = devIndex + 1; i < m_LVOffsets.size(); i++)
+            m_LVOffsets[i] += delta;
+
+    LVSizeMap()->insert(lvPath, size);
 }
 
 const QStringList LvmDevice::deviceNodes() const
@@ -299,6 +476,28 @@ QString LvmDevice::getField(const QString& fieldName, const QString& vgName)
     return QString();
 }
 
+/** Get the thin pool of a LV
+ *
+ * @param lvPath LVM Logical Volume path
+ * @return name of the thin pool, or an empty string if the LV is not a thin volume
+ */
+QString LvmDevice::getThinPool(const QString& lvPath)
+{
+    ExternalCommand cmd(QStringLiteral("lvm"),
+            { QStringLiteral("lvs"),
+              QStringLiteral("--foreign"),
+              QStringLiteral("--readonly"),
+              QStringLiteral("--noheadings"),
+              QStringLiteral("--options"),
+              QStringLiteral("pool_lv"),
+              lvPath });
+
+    if (cmd.run(-1) && cmd.exitCode() == 0)
+        return cmd.output().trimmed();
+
+    return QString();
+}
+
 qint64 LvmDevice::getTotalLE(const QString& lvPath)
 {
     ExternalCommand cmd(QStringLiteral("lvm"),
@@ -323,6 +522,7 @@ bool LvmDevice::removeLV(Report& report, LvmDevice& d, Partition& p)
               p.partitionPath()});
 
     if (cmd.run(-1) && cmd.exitCode() == 0) {
+        d.removeFromLayout(p.partitionPath());
         d.partitionTable()->remove(&p);
         return  true;
     }
@@ -340,7 +540,11 @@ bool LvmDevice::createLV(Report& report, LvmDevice& d, Partition& p, const QStri
               lvName,
               d.name()});
 
-    return (cmd.run(-1) && cmd.exitCode() == 0);
+    if (cmd.run(-1) && cmd.exitCode() == 0) {
+        d.addToLayout(p.partitionPath(), p.length());
+        return true;
+    }
+    return false;
 }
 
 bool LvmDevice::createLVSnapshot(Report& report, Partition& p, const QString& name, const qint64 extents)
@@ -359,7 +563,63 @@ bool LvmDevice::createLVSnapshot(Report& report, Partition& p, const QString& na
     return (cmd.run(-1) && cmd.exitCode() == 0);
 }
 
-bool LvmDevice::resizeLV(Report& report, Partition& p)
+/** Clone a thin LV by creating a writable thin snapshot of it.
+ *
+ * The snapshot shares all blocks with its origin in the thin pool, so this only
+ * writes LVM metadata. It is a standalone LV afterwards: removing the origin
+ * does not affect it. If activating or growing it fails, the snapshot is removed again.
+ *
+ * @param report the Report to write output to
+ * @param d the VG that contains both LVs
+ * @param source the thin LV to clone
+ * @param target the new LV, grown to its length if that is larger than the source
+ * @param lvName name of the new LV
+ * @return true on success
+ */
+bool LvmDevice::cloneThinLV(Report& report, LvmDevice& d, const Partition& source, Partition& target, const QString& lvName)
+{
+    ExternalCommand snapshot(report, QStringLiteral("lvm"),
+            { QStringLiteral("lvcreate"),
+              QStringLiteral("--yes"),
+              QStringLiteral("--snapshot"),
+              QStringLiteral("--setactivationskip"), QStringLiteral("n"),
+              QStringLiteral("--permission"), QStringLiteral("rw"),
+              QStringLiteral("--name"),
+              lvName,
+              source.partitionPath() });
+
+    if (!snapshot.run(-1) || snapshot.exitCode() != 0)
+        return false;
+
+    ExternalCommand activate(report, QStringLiteral("lvm"),
+            { QStringLiteral("lvchange"),
+              QStringLiteral("--activate"), QStringLiteral("y"),
+              target.partitionPath() });
+
+    bool rval = activate.run(-1) && activate.exitCode() == 0;
+
+    if (rval) {
+        d.addToLayout(target.partitionPath(), source.length());
+
+        if (target.length() > source.length() && !(rval = resizeLV(report, d, target)))
+            d.removeFromLayout(target.partitionPath());
+    }
+
+    // do not leave a half set up snapshot behind
+    if (!rval) {
+        ExternalCommand remove(report, QStringLiteral("lvm"),
+                { QStringLiteral("lvremove"),
+                  QStringLiteral("--yes"),
+                  target.partitionPath() });
+
+        if (!remove.run(-1) || remove.exitCode() != 0)
+            report.line() << xi18nc("@info:progress", "Could not remove thin snapshot <filename>%1</filename>.", target.partitionPath());
+    }
+
+    return rval;
+}
+
+bool LvmDevice::resizeLV(Report& report, LvmDevice& d, Partition& p)
 {
     ExternalCommand cmd(report, QStringLiteral("lvm"),
             { QStringLiteral("lvresize"),
@@ -369,7 +629,11 @@ bool LvmDevice::resizeLV(Report& report, Partition& p)
               QString::number(p.length()),
               p.partitionPath()});
 
-    return (cmd.run(-1) && cmd.exitCode() == 0);
+    if (cmd.run(-1) && cmd.exitCode() == 0) {
+        d.resizeInLayout(p.partitionPath(), p.length());
+        return true;
+    }
+    return false;
 }
 
 bool LvmDevice::removePV(Report& report, LvmDevice& d, const QString& pvPath)
@@ -393,6 +657,112 @@ bool LvmDevice::insertPV(Report& report, LvmDevice& d, const QString& pvPath)
     return (cmd.run(-1) && cmd.exitCode() == 0);
 }
 
+/** Remove several PVs from a VG with as few vgreduce calls as the lvm shell's line length allows.
+ *
+ * vgreduce handles the PVs one by one, so if it fails, some of them may already have been
+ * removed. In that case the PVs that are still in the VG are removed one at a time, so that
+ * the Report shows which of them failed.
+ *
+ * @param report the Report to write output to
+ * @param d the VG to remove the PVs from
+ * @param pvList paths of the PVs to remove
+ * @return true on success
+ */
+bool LvmDevice::removePVs(Report& report, LvmDevice& d, const QStringList& pvList)
+{
+    if (pvList.size() < 2)
+        return pvList.isEmpty() || removePV(report, d, pvList.first());
+
+    bool reduced = true;
+
+    // as many PVs per vgreduce as fit on an lvm shell command line
+    for (const auto &pvPaths : splitForLvmShell(pvList, 2)) {
+        ExternalCommand cmd(report, QStringLiteral("lvm"),
+                QStringList() << QStringLiteral("vgreduce")
+                              << d.name()
+                              << pvPaths);
+
+        if (!cmd.run(-1) || cmd.exitCode() != 0) {
+            reduced = false;
+            break;
+        }
+    }
+
+    if (reduced)
+        return true;
+
+    report.line() << xi18nc("@info:progress", "Removing Physical Volumes from <filename>%1</filename> in one step failed, removing them one at a time.", d.name());
+
+    // earlier batches may have gone through; if membership cannot be queried, try all of them
+    bool ok;
+    QStringList remaining = membersOf(d.name(), pvList, ok);
+    if (!ok)
+        remaining = pvList;
+
+    for (const auto &pvPath : remaining) {
+        if (!removePV(report, d, pvPath)) {
+            report.line() << xi18nc("@info:progress", "Could not remove Physical Volume <filename>%1</filename> from <filename>%2</filename>.", pvPath, d.name());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** Add several PVs to a VG with as few vgextend calls as the lvm shell's line length allows.
+ *
+ * vgextend does not change the VG if one of the PVs cannot be added. In that case the
+ * PVs that earlier calls have not added yet are added one at a time, so that the Report
+ * shows which of them failed.
+ *
+ * @param report the Report to write output to
+ * @param d the VG to add the PVs to
+ * @param pvList paths of the PVs to add
+ * @return true on success
+ */
+bool LvmDevice::insertPVs(Report& report, LvmDevice& d, const QStringList& pvList)
+{
+    if (pvList.size() < 2)
+        return pvList.isEmpty() || insertPV(report, d, pvList.first());
+
+    bool extended = true;
+
+    // as many PVs per vgextend as fit on an lvm shell command line
+    for (const auto &pvPaths : splitForLvmShell(pvList, 3)) {
+        ExternalCommand cmd(report, QStringLiteral("lvm"),
+                QStringList() << QStringLiteral("vgextend")
+                              << QStringLiteral("--yes")
+                              << d.name()
+                              << pvPaths);
+
+        if (!cmd.run(-1) || cmd.exitCode() != 0) {
+            extended = false;
+            break;
+        }
+    }
+
+    if (extended)
+        return true;
+
+    report.line() << xi18nc("@info:progress", "Adding Physical Volumes to <filename>%1</filename> in one step failed, adding them one at a time.", d.name());
+
+    // skip the PVs earlier batches already added
+    bool ok;
+    const QStringList added = membersOf(d.name(), pvList, ok);
+
+    for (const auto &pvPath : pvList) {
+        if (added.contains(pvPath))
+            continue;
+
+        if (!insertPV(report, d, pvPath)) {
+            report.line() << xi18nc("@info:progress", "Could not add Physical Volume <filename>%1</filename> to <filename>%2</filename>.", pvPath, d.name());
+            return false;
+        }
+    }
+
+    return true;
+}
+
 bool LvmDevice::movePV(Report& report, const QString& pvPath, const QStringList& destinations)
 {
     if (FS::lvm2_pv::getAllocatedPE(pvPath) <= 0)
@@ -419,7 +789,17 @@ bool LvmDevice::createVG(Report& report, const QString vgName, const QStringList
 
     ExternalCommand cmd(report, QStringLiteral("lvm"), args);
 
-    return (cmd.run(-1) && cmd.exitCode() == 0);
+    if (cmd.run(-1) && cmd.exitCode() == 0)
+        return true;
+
+    // vgcreate handles all PVs at once, point out the ones that cannot be used
+    for (const auto &pvNode : pvList) {
+        const QString otherVG = FS::lvm2_pv::getVGName(pvNode.trimmed());
+        if (!otherVG.isEmpty())
+            report.line() << xi18nc("@info:progress", "Physical Volume <filename>%1</filename> already belongs to Volume Group <filename>%2</filename>.", pvNode.trimmed(), otherVG);
+    }
+
+    return false;
 }
 
 bool LvmDevice::removeVG(Report& report, LvmDevice& d)
@@ -458,6 +838,27 @@ bool LvmDevice::activateVG(Report& report, const LvmDevice& d)
     return deactivate.run(-1) && deactivate.exitCode() == 0;
 }
 
+/** Activate several LVs with as few lvm commands as the lvm shell's line length allows
+ *
+ * @param lvPathList paths of the LVs to activate
+ * @return true on success
+ */
+bool LvmDevice::activateLVs(const QStringList& lvPathList)
+{
+    bool rval = true;
+
+    for (const auto &lvPaths : splitForLvmShell(lvPathList, 3)) {
+        ExternalCommand activate(QStringLiteral("lvm"),
+                QStringList() << QStringLiteral("lvchange")
+                              << QStringLiteral("--activate") << QStringLiteral("y")
+                              << lvPaths);
+        if (!activate.run(-1) || activate.exitCode() != 0)
+            rval = false;
+    }
+
+    return rval;
+}
+
 bool LvmDevice::activateLV(const QString& lvPath)
 {
     ExternalCommand deactivate(QStringLiteral("lvm"),
@@ -23,10 +23,12 @@
 #include "core/volumemanagerdevice.h"
 #include "util/libpartitionmanagerexport.h"
 
+#include <QHash>
 #include <QString>
 #include <QObject>
 #include <QtGlobal>
 #include <QStringList>
+#include <QVector>
 
 class PartitionTable;
 class Report;
@@ -68,16 +70,21 @@ public:
     static QString getField(const QString& fieldName, const QString& vgName = QString());
 
     static qint64 getTotalLE(const QString& lvPath);
+    static QString getThinPool(const QString& lvPath);
 
     static bool removeLV(Report& report, LvmDevice& d, Partition& p);
     static bool createLV(Report& report, LvmDevice& d, Partition& p, const QString& lvName);
     static bool createLVSnapshot(Report& report, Partition& p, const QString& name, const qint64 extents = 0);
-    static bool resizeLV(Report& report, Partition& p);
+    static bool cloneThinLV(Report& report, LvmDevice& d, const Partition& source, Partition& target, const QString& lvName);
+    static bool resizeLV(Report& report, LvmDevice& d, Partition& p);
     static bool deactivateLV(Report& report, const Partition& p);
     static bool activateLV(const QString& deviceNode);
+    static bool activateLVs(const QStringList& lvPathList);
 
     static bool removePV(Report& report, LvmDevice& d, const QString& pvPath);
     static bool insertPV(Report& report, LvmDevice& d, const QString& pvPath);
+    static bool removePVs(Report& report, LvmDevice& d, const QStringList& pvList);
+    static bool insertPVs(Report& report, LvmDevice& d, const QStringList& pvList);
     static bool movePV(Report& report, const QString& pvPath, const QStringList& destinations = QStringList());
 
     static bool removeVG(Report& report, LvmDevice& d);
@@ -89,9 +96,12 @@ protected:
 
     void initPartitions() override;
     const QList<Partition*> scanPartitions(PartitionTable* pTable) const;
-    Partition* scanPartition(const QString& lvPath, PartitionTable* pTable) const;
     qint64 mappedSector(const QString& lvPath, qint64 sector) const override;
 
+    void addToLayout(const QString& lvPath, qint64 size) const;
+    void removeFromLayout(const QString& lvPath) const;
+    void resizeInLayout(const QString& lvPath, qint64 size) const;
+
 public:
     qint64 peSize() const {
         return m_peSize;
@@ -132,6 +142,11 @@ private:
     mutable QStringList* m_LVPathList;
     mutable QList <const Partition*> m_PVs;
     mutable QMap<QString, qint64>* m_LVSizeMap;
+
+    /** Position of each LV in the abstract VG partition table. m_LVOffsets[i] is the first
+        sector of the i-th LV, the last element is the total size of all LVs. */
+    mutable QHash<QString, qint32> m_LVIndex;
+    mutable QVector<qint64> m_LVOffsets;
 };
 
 #endif
@@ -18,13 +18,55 @@
 
 #include "core/operationrunner.h"
 
+#include "backend/corebackendmanager.h"
+#include "backend/devicehandlepool.h"
+#include "backend/partitiontabletransaction.h"
+
+#include "core/device.h"
+#include "core/durationestimator.h"
 #include "core/operationstack.h"
 
+#include "jobs/checkfilesystemjob.h"
+
 #include "ops/operation.h"
 
+#include "util/externalcommand.h"
+#include "util/lvmcommandsession.h"
 #include "util/report.h"
 
+#include <QHash>
 #include <QMutex>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include <functional>
+
+namespace
+{
+/** An Operation that left uncommitted edits on a partition table */
+struct BatchedEdit {
+    qint32 op;
+    QString deviceNode;
+    qint32 batch;
+};
+
+class OperationRunnable : public QRunnable
+{
+public:
+    explicit OperationRunnable(const std::function<void()>& f) :
+        m_Function(f)
+    {
+    }
+
+    void run() override {
+        m_Function();
+    }
+
+private:
+    std::function<void()> m_Function;
+};
+}
 
 /** Constructs an OperationRunner.
     @param ostack the OperationStack to act on
@@ -34,40 +76,143 @@ OperationRunner::OperationRunner(QObject* parent, OperationStack& ostack) :
     m_OperationStack(ostack),
     m_Report(nullptr),
     m_SuspendMutex(),
-    m_Cancelling(false)
+    m_Cancelling(false),
+    m_MaxParallelOperations(1)
 {
 }
 
-/** Runs the operations in the OperationStack. */
+/** Runs the operations in the OperationStack.
+
+    Operations are started in stack order as soon as all Operations they depend on have finished.
+    Once an Operation has failed or the user has cancelled, no further Operations are started, but
+    those already running are allowed to finish.
+*/
 void OperationRunner::run()
 {
     Q_ASSERT(m_Report);
 
     setCancelling(false);
 
+    // nothing queried before this pass can be trusted once it starts changing things
+    ExternalCommand::invalidateCache();
+    CheckFileSystemJob::clearCheckedCache();
+
+    // consecutive partition table edits on a Device share one commit
+    PartitionTableTransaction transaction;
+
+    // consecutive Jobs copying sectors on a Device share one open backend device
+    DeviceHandlePool handles;
+
+    const QList<Operation*> ops = operationStack().operations();
+    const QVector<QList<qint32>> deps = dependencies();
+
+    QVector<qint32> waitingFor(ops.size());
+    QVector<QList<qint32>> dependents(ops.size());
+    for (int i = 0; i < ops.size(); i++) {
+        waitingFor[i] = deps[i].size();
+        for (const auto &dep : deps[i])
+            dependents[dep].append(i);
+    }
+
+    // the partition tables an Operation may leave uncommitted edits on
+    QVector<QStringList> targetNodes(ops.size());
+    for (int i = 0; i < ops.size(); i++)
+        for (const auto &d : operationStack().previewDevices())
+            if (ops[i]->targets(*d))
+                targetNodes[i].append(d->deviceNode());
+
+    DurationEstimator estimator(ops);
+    connect(&estimator, &DurationEstimator::changed, this, [this, &deps, &estimator] {
+        emit timeLeftChanged(wallTime(deps, estimator.timeLeft()));
+    }, Qt::DirectConnection);
+
+    // worker threads live as long as the pool, i.e. for this pass, and so do their LVM sessions
+    QThreadPool pool;
+    pool.setMaxThreadCount(maxParallelOperations());
+    pool.setExpiryTimeout(-1);
+
+    QMutex stateMutex;
+    QWaitCondition opDone;
+    QVector<bool> started(ops.size(), false);
+    QList<qint32> done;
+    QList<BatchedEdit> batched;
+    qint32 running = 0;
     bool status = true;
 
-    for (int i = 0; i < numOperations(); i++) {
-        suspendMutex().lock();
+    forever {
+        stateMutex.lock();
+
+        while (!done.isEmpty())
+            for (const auto &dependent : dependents[done.takeFirst()])
+                waitingFor[dependent]--;
+
+        qint32 next = -1;
+        if (status && !isCancelling() && running < maxParallelOperations()) {
+            for (int i = 0; i < ops.size(); i++) {
+                if (!started[i] && waitingFor[i] == 0) {
+                    next = i;
+                    break;
+                }
+            }
+        }
 
-        if (!status || isCancelling()) {
-            suspendMutex().unlock();
-            break;
+        if (next < 0) {
+            if (running == 0) {
+                stateMutex.unlock();
+                break;
+            }
+            opDone.wait(&stateMutex);
+            stateMutex.unlock();
+            continue;
         }
 
-        Operation* op = operationStack().operations()[i];
+        started[next] = true;
+        running++;
+        stateMutex.unlock();
+
+        // blocks while the user has suspended us
+        suspendMutex().lock();
+
+        Operation* op = ops[next];
         op->setStatus(Operation::StatusRunning);
 
-        emit opStarted(i + 1, op);
+        emit opStarted(next + 1, op);
 
         connect(op, &Operation::progress, this, &OperationRunner::progressSub);
 
-        status = op->execute(report());
-        op->preview();
+        pool.start(new OperationRunnable([this, op, next, &transaction, &targetNodes, &estimator, &stateMutex, &opDone, &done, &batched, &running, &status] {
+            // LVM only pays its startup, locking and device scan once per worker thread and pass:
+            // the session is created with the thread's first Operation and quits when the thread does
+            static thread_local LvmCommandSession lvmSession;
+            Q_UNUSED(lvmSession);
+
+            const bool rval = op->execute(report());
 
-        disconnect(op, &Operation::progress, this, &OperationRunner::progressSub);
+            {
+                // other Operations may be reading the Partitions this changes
+                QMutexLocker backendLocker(&CoreBackendManager::self()->mutex());
+                op->preview();
+            }
 
-        emit opFinished(i + 1, op);
+            disconnect(op, &Operation::progress, this, &OperationRunner::progressSub);
+
+            emit opFinished(next + 1, op);
+            estimator.operationFinished(next);
+
+            QMutexLocker locker(&stateMutex);
+            if (!rval)
+                status = false;
+            for (const auto &node : targetNodes[next]) {
+                BatchedEdit edit;
+                edit.op = next;
+                edit.deviceNode = node;
+                if (transaction.hasPendingEdits(node, &edit.batch))
+                    batched.append(edit);
+            }
+            done.append(next);
+            running--;
+            opDone.wakeAll();
+        }));
 
         suspendMutex().unlock();
 
@@ -77,6 +222,27 @@ void OperationRunner::run()
         msleep(5);
     }
 
+    pool.waitForDone();
+
+    handles.close();
+
+    // the Operations whose edits were only committed now have failed if that commit failed
+    QHash<QString, qint32> lastBatch;
+    for (const auto &edit : batched) {
+        qint32 batch;
+        if (transaction.hasPendingEdits(edit.deviceNode, &batch))
+            lastBatch[edit.deviceNode] = batch;
+    }
+
+    QStringList failedDevices;
+    if (!transaction.commit(&report(), &failedDevices)) {
+        status = false;
+
+        for (const auto &edit : batched)
+            if (failedDevices.contains(edit.deviceNode) && lastBatch.value(edit.deviceNode, -1) == edit.batch)
+                ops[edit.op]->setStatus(Operation::StatusError);
+    }
+
     if (!status)
         emit error();
     else if (isCancelling())
@@ -85,6 +251,87 @@ void OperationRunner::run()
         emit finished();
 }
 
+/** Finds out which Operations have to wait for which other Operations.
+
+    An Operation depends on every earlier Operation that targets or reads from one of the Devices it
+    targets or reads from. Operations on LVM devices (whose physical volumes live on other Devices),
+    and Operations that neither target nor read any known Device, depend on all earlier Operations
+    and all later Operations depend on them.
+
+    @return for each Operation the indexes of the earlier Operations it depends on
+*/
+QVector<QList<qint32>> OperationRunner::dependencies() const
+{
+    const QList<Operation*> ops = operationStack().operations();
+
+    QVector<QList<const Device*>> footprint(ops.size());
+    QVector<bool> barrier(ops.size(), false);
+
+    for (int i = 0; i < ops.size(); i++) {
+        for (const auto &d : operationStack().previewDevices()) {
+            if (ops[i]->targets(*d) || ops[i]->readsFrom(*d)) {
+                footprint[i].append(d);
+                if (d->type() == Device::LVM_Device)
+                    barrier[i] = true;
+            }
+        }
+        if (footprint[i].isEmpty())
+            barrier[i] = true;
+    }
+
+    QVector<QList<qint32>> deps(ops.size());
+    for (int i = 0; i < ops.size(); i++) {
+        for (int j = 0; j < i; j++) {
+            bool shared = barrier[i] || barrier[j];
+            for (int k = 0; !shared && k < footprint[i].size(); k++)
+                shared = footprint[j].contains(footprint[i][k]);
+            if (shared)
+                deps[i].append(j);
+        }
+    }
+
+    return deps;
+}
+
+/** Predicts how long running Operations with the given durations takes.
+
+    Independent Operations overlap, so this is the longest chain of dependent Operations, but
+    no less than the total spread evenly over maxParallelOperations() threads.
+
+    @param deps for each Operation the Operations it depends on, see dependencies()
+    @param durations for each Operation its predicted duration in milliseconds
+    @return the predicted wall clock duration in milliseconds
+*/
+qint64 OperationRunner::wallTime(const QVector<QList<qint32>>& deps, const QVector<qint64>& durations) const
+{
+    QVector<qint64> finish(durations.size(), 0);
+    qint64 longestChain = 0;
+    qint64 total = 0;
+
+    for (int i = 0; i < durations.size(); i++) {
+        for (const auto &dep : deps[i])
+            finish[i] = qMax(finish[i], finish[dep]);
+
+        finish[i] += durations[i];
+        longestChain = qMax(longestChain, finish[i]);
+        total += durations[i];
+    }
+
+    return qMax(longestChain, total / maxParallelOperations());
+}
+
+/** @return the predicted time in milliseconds running all Operations is going to take */
+qint64 OperationRunner::estimatedDuration() const
+{
+    const QList<Operation*> ops = operationStack().operations();
+
+    QVector<qint64> durations(ops.size());
+    for (int i = 0; i < ops.size(); i++)
+        durations[i] = DurationEstimator::estimate(*ops[i]);
+
+    return wallTime(dependencies(), durations);
+}
+
 /** @return the number of Operations to run */
 qint32 OperationRunner::numOperations() const
 {
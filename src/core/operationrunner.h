@@ -23,6 +23,8 @@
 
 #include <QThread>
 #include <QMutex>
+#include <QList>
+#include <QVector>
 #include <QtGlobal>
 
 class Operation;
@@ -33,6 +35,22 @@ class Report;
 
     Runs the OperationStack when the user applies operations.
 
+    Operations that share no Device are independent and may run concurrently on up to
+    maxParallelOperations() threads; by default they run one by one. Calls into the backend and
+    previewing finished Operations are serialized by CoreBackendManager::mutex() either way.
+    Operations sharing a Device (as a target or as a source) run in stack order, and Operations
+    on LVM devices or whose devices are unknown run on their own. opStarted() and opFinished()
+    are emitted for every Operation as it starts and finishes, progressSub() carries the progress
+    of the most recently reporting Operation.
+
+    Partition table edits are batched by a PartitionTableTransaction for the whole run, so
+    consecutive edits on a Device are committed together. Likewise, a DeviceHandlePool keeps
+    exclusively opened devices open between Jobs and only closes them when the run is over, and
+    every worker thread streams its LVM commands to one LvmCommandSession for the whole run.
+
+    estimatedDuration() predicts how long running the OperationStack will take; while running,
+    timeLeftChanged() carries the prediction refined by the progress of the running Jobs.
+
     @author Volker Lanz <vl@fidra.de>
 */
 class LIBKPMCORE_EXPORT OperationRunner : public QThread
@@ -58,12 +76,20 @@ public:
         return m_SuspendMutex;    /**< @return the QMutex used for syncing */
     }
     QString description(qint32 op) const;
+    qint64 estimatedDuration() const;
     void setReport(Report* report) {
         m_Report = report;    /**< @param report the Report to use while running */
     }
+    qint32 maxParallelOperations() const {
+        return m_MaxParallelOperations;    /**< @return the maximum number of Operations run at the same time */
+    }
+    void setMaxParallelOperations(qint32 n) {
+        m_MaxParallelOperations = qMax(1, n);    /**< @param n the maximum number of Operations run at the same time, 1 to run them one by one */
+    }
 
 Q_SIGNALS:
     void progressSub(int);
+    void timeLeftChanged(qint64);
     void opStarted(int, Operation*);
     void opFinished(int, Operation*);
     void finished();
@@ -85,11 +111,15 @@ protected:
         return *m_Report;
     }
 
+    QVector<QList<qint32>> dependencies() const;
+    qint64 wallTime(const QVector<QList<qint32>>& deps, const QVector<qint64>& durations) const;
+
 private:
     OperationStack& m_OperationStack;
     Report* m_Report;
     mutable QMutex m_SuspendMutex;
     mutable volatile bool m_Cancelling;
+    qint32 m_MaxParallelOperations;
 };
 
 #endif
@@ -37,6 +37,7 @@
 
 #include "fs/filesystemfactory.h"
 
+#include "util/capacity.h"
 #include "util/globallog.h"
 
 #include <KLocalizedString>
@@ -49,8 +50,15 @@ OperationStack::OperationStack(QObject* parent) :
     QObject(parent),
     m_Operations(),
     m_PreviewDevices(),
+    m_Snapshots(),
+    m_DevicesByNode(),
+    m_DevicesByTable(),
+    m_PhysicalVolumesByPath(),
+    m_PhysicalVolumesIndexed(false),
+    m_IndexMutex(),
     m_Lock(QReadWriteLock::Recursive)
 {
+    resetSnapshots();
 }
 
 /** Destructs an OperationStack, cleaning up Operations and Devices */
@@ -395,6 +403,227 @@ bool OperationStack::mergeCreatePartitionTableOperation(Operation*& currentOp, O
     return false;
 }
 
+/** Tries to merge an existing ResizeOperation with a new ResizeOperation pushed on the OperationStack.
+
+    If a Partition that is already being resized or moved is now being resized or moved again,
+    remove the existing ResizeOperation and replace the pushed one with a single ResizeOperation
+    that goes straight from the original geometry to the final one. This avoids moving the
+    file system's data twice. If the final geometry is the original one, both operations are
+    dropped.
+
+    This only applies if no other Operation on the same Device was pushed in between, and
+    never to extended partitions (see mergeNewOperation()).
+
+    @param currentOp the Operation already on the stack to try to merge with
+    @param pushedOp the newly pushed Operation
+    @return true if the OperationStack has been modified in a way that requires merging to stop
+*/
+bool OperationStack::mergeResizeOperation(Operation*& currentOp, Operation*& pushedOp)
+{
+    ResizeOperation* resizeOp = dynamic_cast<ResizeOperation*>(currentOp);
+
+    if (resizeOp == nullptr)
+        return false;
+
+    ResizeOperation* pushedResizeOp = dynamic_cast<ResizeOperation*>(pushedOp);
+
+    if (pushedResizeOp && &resizeOp->partition() == &pushedResizeOp->partition() &&
+            !resizeOp->partition().roles().has(PartitionRole::Extended) &&
+            !targetedAfter(resizeOp, resizeOp->targetDevice())) {
+        const qint64 bytesBefore = bytesMoved(*resizeOp) + bytesMoved(*pushedResizeOp);
+        const qint64 newFirst = pushedResizeOp->newFirstSector();
+        const qint64 newLast = pushedResizeOp->newLastSector();
+
+        resizeOp->undo();
+        operations().removeAt(operations().indexOf(resizeOp));
+
+        delete pushedOp;
+        pushedOp = nullptr;
+
+        if (newFirst == resizeOp->origFirstSector() && newLast == resizeOp->origLastSector())
+            Log() << xi18nc("@info:status", "Resizing a partition back to its original size and position: Removing the resize operations.");
+        else {
+            pushedOp = new ResizeOperation(resizeOp->targetDevice(), resizeOp->partition(), newFirst, newLast);
+            Log() << xi18nc("@info:status", "Resizing a partition again: Combining both resize operations (data to move: %1 instead of %2).",
+                            Capacity::formatByteSize(bytesMoved(*pushedOp)), Capacity::formatByteSize(bytesBefore));
+        }
+
+        delete resizeOp;
+
+        return true;
+    }
+
+    return false;
+}
+
+/** Tries to merge an existing CheckOperation with a new Operation pushed on the OperationStack or vice versa.
+
+    Resizing, moving and copying a Partition always checks the involved file systems before and
+    after the operation, so a separate check right before or after one of these is redundant:
+
+    <ol>
+    <!-- 1 -->
+    <li>An existing CheckOperation checks a Partition that is now being resized, moved or used
+        as the source of a copy: Remove the CheckOperation.</li>
+    <!-- 2 -->
+    <li>A Partition that was just resized, moved or copied to is now being checked: Forget the
+        pushed CheckOperation.</li>
+    </ol>
+
+    Both only apply if no other Operation has targeted the Partition in between and it is not
+    mounted, because operations skip checks on mounted file systems.
+
+    @param currentOp the Operation already on the stack to try to merge with
+    @param pushedOp the newly pushed Operation
+    @return true if the OperationStack has been modified in a way that requires merging to stop
+*/
+bool OperationStack::mergeCheckOperation(Operation*& currentOp, Operation*& pushedOp)
+{
+    CheckOperation* checkOp = dynamic_cast<CheckOperation*>(currentOp);
+    CheckOperation* pushedCheckOp = dynamic_cast<CheckOperation*>(pushedOp);
+
+    // -- 1 --
+    if (checkOp && !checkOp->checkedPartition().isMounted() && !targetedAfter(checkOp, checkOp->checkedPartition())) {
+        const Partition* checked = &checkOp->checkedPartition();
+        const ResizeOperation* pushedResizeOp = dynamic_cast<ResizeOperation*>(pushedOp);
+        const CopyOperation* pushedCopyOp = dynamic_cast<CopyOperation*>(pushedOp);
+
+        if ((pushedResizeOp && &pushedResizeOp->partition() == checked) ||
+                (pushedCopyOp && &pushedCopyOp->sourcePartition() == checked)) {
+            Log() << xi18nc("@info:status", "Checking a partition right before it is resized, moved or copied: Removing the redundant check.");
+
+            checkOp->undo();
+            delete operations().takeAt(operations().indexOf(checkOp));
+
+            return true;
+        }
+    }
+
+    // -- 2 --
+    if (pushedCheckOp && !pushedCheckOp->checkedPartition().isMounted() && !targetedAfter(currentOp, pushedCheckOp->checkedPartition())) {
+        const Partition* checked = &pushedCheckOp->checkedPartition();
+        const ResizeOperation* resizeOp = dynamic_cast<ResizeOperation*>(currentOp);
+        const CopyOperation* copyOp = dynamic_cast<CopyOperation*>(currentOp);
+
+        if ((resizeOp && &resizeOp->partition() == checked) ||
+                (copyOp && &copyOp->copiedPartition() == checked)) {
+            Log() << xi18nc("@info:status", "Checking a partition that was just resized, moved or copied: Removing the redundant check.");
+
+            delete pushedOp;
+            pushedOp = nullptr;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/** @return true if an Operation pushed after the given one targets the given Partition
+    @param op the Operation on the stack to start looking after
+    @param p the Partition to look for
+*/
+bool OperationStack::targetedAfter(const Operation* op, const Partition& p) const
+{
+    for (int i = operations().indexOf(const_cast<Operation*>(op)) + 1; i < operations().size(); i++)
+        if (operations()[i]->targets(p))
+            return true;
+
+    return false;
+}
+
+/** @return true if an Operation pushed after the given one targets the given Device
+    @param op the Operation on the stack to start looking after
+    @param d the Device to look for
+*/
+bool OperationStack::targetedAfter(const Operation* op, const Device& d) const
+{
+    for (int i = operations().indexOf(const_cast<Operation*>(op)) + 1; i < operations().size(); i++)
+        if (operations()[i]->targets(d))
+            return true;
+
+    return false;
+}
+
+/** Estimates how much file system data an Operation is going to move or copy.
+
+    Moving a Partition moves its file system after shrinking or before growing it, so the
+    smaller of the two lengths is moved. Copying a Partition copies the whole source file system.
+
+    @param op the Operation to look at
+    @return the number of bytes the Operation will move, or 0 if it does not move any data
+*/
+qint64 OperationStack::bytesMoved(const Operation& op)
+{
+    const ResizeOperation* resizeOp = dynamic_cast<const ResizeOperation*>(&op);
+    if (resizeOp && resizeOp->newFirstSector() != resizeOp->origFirstSector() && !resizeOp->partition().roles().has(PartitionRole::Extended))
+        return qMin(resizeOp->origLength(), resizeOp->newLength()) * resizeOp->targetDevice().logicalSize();
+
+    const CopyOperation* copyOp = dynamic_cast<const CopyOperation*>(&op);
+    if (copyOp)
+        return copyOp->sourcePartition().fileSystem().length() * copyOp->sourceDevice().logicalSize();
+
+    return 0;
+}
+
+/** @return the number of bytes all Operations on the stack are predicted to move or copy */
+qint64 OperationStack::predictedBytesMoved() const
+{
+    qint64 rval = 0;
+
+    for (const auto &o : operations())
+        rval += bytesMoved(*o);
+
+    return rval;
+}
+
+/** Returns the layout of a Device as previewed after some of the Operations.
+
+    Snapshots are taken while Operations are pushed, so this only looks them up.
+
+    @param d the Device to get the layout of
+    @param n the number of Operations from the bottom of the stack to apply; 0 for the original layout
+    @return snapshots of the Device's partitions, empty if it has no PartitionTable
+*/
+PartitionSnapshot::Children OperationStack::snapshot(const Device& d, qint32 n) const
+{
+    Q_ASSERT(n >= 0 && n <= operations().size());
+
+    return n >= 0 && n < m_Snapshots.size() ? m_Snapshots[n].value(&d) : PartitionSnapshot::Children();
+}
+
+/** Takes a snapshot of the current preview and appends it to the list of snapshots.
+    @param o the Operation just previewed; only the Devices it targets are looked at. If nullptr, all Devices are.
+*/
+void OperationStack::appendSnapshot(const Operation* o)
+{
+    QHash<const Device*, PartitionSnapshot::Children> devices;
+    if (!m_Snapshots.isEmpty())
+        devices = m_Snapshots.last();
+
+    for (const auto &d : previewDevices())
+        if (o == nullptr || !devices.contains(d) || o->targets(*d))
+            devices.insert(d, d->partitionTable() ? PartitionSnapshot::take(*d->partitionTable(), devices.value(d)) : PartitionSnapshot::Children());
+
+    m_Snapshots.append(devices);
+}
+
+/** Forgets all but the first snapshots.
+    @param n the number of snapshots to keep
+*/
+void OperationStack::truncateSnapshots(qint32 n)
+{
+    while (m_Snapshots.size() > n)
+        m_Snapshots.removeLast();
+}
+
+/** Takes the current preview as the original layout and forgets all other snapshots. */
+void OperationStack::resetSnapshots()
+{
+    truncateSnapshots(0);
+    appendSnapshot(nullptr);
+}
+
 /** Pushes a new Operation on the OperationStack.
 
     This method will call all methods that try to merge the new Operation with the
@@ -408,31 +637,58 @@ void OperationStack::push(Operation* o)
 {
     Q_ASSERT(o);
 
-    for (auto currentOp = operations().rbegin(); currentOp != operations().rend(); ++currentOp) {
-        if (mergeNewOperation(*currentOp, o))
+    const qint32 stackSize = operations().size();
+    qint32 mergedAt = stackSize - 1;
+
+    for (; mergedAt >= 0; mergedAt--) {
+        Operation*& currentOp = operations()[mergedAt];
+
+        if (mergeNewOperation(currentOp, o))
+            break;
+
+        if (mergeCopyOperation(currentOp, o))
             break;
 
-        if (mergeCopyOperation(*currentOp, o))
+        if (mergeRestoreOperation(currentOp, o))
             break;
 
-        if (mergeRestoreOperation(*currentOp, o))
+        if (mergePartFlagsOperation(currentOp, o))
             break;
 
-        if (mergePartFlagsOperation(*currentOp, o))
+        if (mergePartLabelOperation(currentOp, o))
             break;
 
-        if (mergePartLabelOperation(*currentOp, o))
+        if (mergeCreatePartitionTableOperation(currentOp, o))
             break;
 
-        if (mergeCreatePartitionTableOperation(*currentOp, o))
+        if (mergeResizeOperation(currentOp, o))
+            break;
+
+        if (mergeCheckOperation(currentOp, o))
             break;
     }
 
+    // Merging changed or removed the Operation at mergedAt. The snapshots below it still hold;
+    // the Operations from there on are undone and previewed again to take theirs, while the
+    // stack is being changed anyway rather than when a snapshot is asked for.
+    if (mergedAt >= 0) {
+        truncateSnapshots(mergedAt + 1);
+
+        for (int i = operations().size() - 1; i >= mergedAt; i--)
+            operations()[i]->undo();
+
+        for (int i = mergedAt; i < operations().size(); i++) {
+            operations()[i]->preview();
+            appendSnapshot(operations()[i]);
+        }
+    }
+
     if (o != nullptr) {
         Log() << xi18nc("@info:status", "Add operation: %1", o->description());
         operations().append(o);
         o->preview();
         o->setStatus(Operation::StatusPending);
+        appendSnapshot(o);
     }
 
     // emit operationsChanged even if o is nullptr because it has been merged: merging might
@@ -446,6 +702,7 @@ void OperationStack::pop()
     Operation* o = operations().takeLast();
     o->undo();
     delete o;
+    truncateSnapshots(operations().size() + 1);
     emit operationsChanged();
 }
 
@@ -482,6 +739,9 @@ void OperationStack::clearOperations()
         delete o;
     }
 
+    // operations that have been applied changed what the original layout is
+    resetSnapshots();
+
     emit operationsChanged();
 }
 
@@ -492,6 +752,11 @@ void OperationStack::clearDevices()
 
     qDeleteAll(previewDevices());
     previewDevices().clear();
+    m_DevicesByNode.clear();
+    m_DevicesByTable.clear();
+    m_PhysicalVolumesByPath.clear();
+    m_PhysicalVolumesIndexed = false;
+    resetSnapshots();
     emit devicesChanged();
 }
 
@@ -503,23 +768,104 @@ Device* OperationStack::findDeviceForPartition(const Partition* p)
 {
     QReadLocker lockDevices(&lock());
 
-    const auto devices = previewDevices();
-    for (Device *d : devices) {
-        if (d->partitionTable() == nullptr)
-            continue;
+    if (p == nullptr || p->parent() == nullptr)
+        return nullptr;
+
+    // logicals are children of an extended partition, all others of the partition table
+    const PartitionNode* table = p->parent()->isRoot() ? p->parent() : p->parent()->parent();
+    if (table == nullptr || !table->isRoot())
+        return nullptr;
+
+    // only partitions that are actually in the table, not ones about to be inserted or just removed
+    if (table->findPartitionBySector(p->firstSector(), p->roles()) != p)
+        return nullptr;
 
-        const auto partitions = d->partitionTable()->children();
-        for (const auto *part : partitions) {
-            if (part == p)
-                return d;
+    // readers may get here at the same time, so filling in the index needs its own lock
+    QMutexLocker lockIndex(&m_IndexMutex);
 
-            for (const auto &child : part->children())
-                if (child == p)
-                    return d;
+    Device* d = m_DevicesByTable.value(table);
+
+    // operations can give a device a new partition table
+    if (d == nullptr || d->partitionTable() != table) {
+        d = nullptr;
+        for (const auto &device : previewDevices()) {
+            if (device->partitionTable() == table) {
+                d = device;
+                m_DevicesByTable.insert(table, d);
+                break;
+            }
         }
     }
 
-    return nullptr;
+    return d;
+}
+
+/** Finds a Device by its device node.
+    @param deviceNode the device node, e.g. /dev/sda or /dev/vg0
+    @return the Device or nullptr if none could be found
+*/
+Device* OperationStack::findDevice(const QString& deviceNode) const
+{
+    QReadLocker lockDevices(&m_Lock);
+
+    return m_DevicesByNode.value(deviceNode);
+}
+
+/** Finds an LVM physical volume by its partition path.
+    @param partitionPath the path of the physical volume's partition, e.g. /dev/sda2
+    @return the physical volume's Partition or nullptr if there is none with that path
+*/
+const Partition* OperationStack::findPhysicalVolume(const QString& partitionPath) const
+{
+    QReadLocker lockDevices(&m_Lock);
+    QMutexLocker lockIndex(&m_IndexMutex);
+
+    if (!m_PhysicalVolumesIndexed) {
+        m_PhysicalVolumesByPath.clear();
+        for (const auto &pv : physicalVolumes())
+            m_PhysicalVolumesByPath.insert(pv.second->partitionPath(), pv.second);
+        m_PhysicalVolumesIndexed = true;
+    }
+
+    return m_PhysicalVolumesByPath.value(partitionPath);
+}
+
+/** Returns the list of LVM physical volumes for changing it in place.
+
+    Kept for compatibility only. The index findPhysicalVolume() uses is rebuilt after every call,
+    but changes made through the returned reference later on are not seen by it; use
+    setPhysicalVolumes() or addPhysicalVolumes() instead.
+
+    @return the list of LVM PVs
+*/
+OperationStack::PhysicalVolumes& OperationStack::physicalVolumes()
+{
+    QMutexLocker lockIndex(&m_IndexMutex);
+    m_PhysicalVolumesIndexed = false;
+
+    return m_LVMPhysicalVolumes;
+}
+
+/** Replaces the list of LVM physical volumes.
+    @param pvs the new list of physical volumes
+*/
+void OperationStack::setPhysicalVolumes(const PhysicalVolumes& pvs)
+{
+    QWriteLocker lockDevices(&lock());
+
+    m_LVMPhysicalVolumes = pvs;
+    m_PhysicalVolumesIndexed = false;
+}
+
+/** Adds LVM physical volumes to the list of physical volumes.
+    @param pvs the physical volumes to add
+*/
+void OperationStack::addPhysicalVolumes(const PhysicalVolumes& pvs)
+{
+    QWriteLocker lockDevices(&lock());
+
+    m_LVMPhysicalVolumes.append(pvs);
+    m_PhysicalVolumesIndexed = false;
 }
 
 /** Adds a Device to the OperationStack
@@ -532,6 +878,15 @@ void OperationStack::addDevice(Device* d)
     QWriteLocker lockDevices(&lock());
 
     previewDevices().append(d);
+    m_DevicesByNode.insert(d->deviceNode(), d);
+    if (d->partitionTable())
+        m_DevicesByTable.insert(d->partitionTable(), d);
+
+    // no Operation on the stack targets a Device that was just added, so it looks the same at every position
+    const PartitionSnapshot::Children layout = d->partitionTable() ? PartitionSnapshot::take(*d->partitionTable()) : PartitionSnapshot::Children();
+    for (auto &devices : m_Snapshots)
+        devices.insert(d, layout);
+
     emit devicesChanged();
 }
 
@@ -19,16 +19,21 @@
 
 #define OPERATIONSTACK__H
 
+#include "core/partitionsnapshot.h"
+
 #include "util/libpartitionmanagerexport.h"
 
 #include <QObject>
+#include <QHash>
 #include <QList>
+#include <QMutex>
 #include <QReadWriteLock>
 
 #include <QtGlobal>
 
 class Device;
 class Partition;
+class PartitionNode;
 class Operation;
 class DeviceScanner;
 
@@ -37,6 +42,10 @@ class DeviceScanner;
     OperationStack also handles the Devices that were found on this computer and the merging of
     Operations, e.g., when the user first creates a Partition, then deletes it.
 
+    For every position in the stack it keeps a snapshot of the Devices' layouts as they are
+    previewed after the Operations up to that position. Snapshots share what did not change
+    between them, see PartitionSnapshot.
+
     @author Volker Lanz <vl@fidra.de>
 */
 class LIBKPMCORE_EXPORT OperationStack : public QObject
@@ -75,9 +84,7 @@ public:
         return m_PreviewDevices;    /**< @return the list of Devices */
     }
 
-    PhysicalVolumes& physicalVolumes() {
-        return m_LVMPhysicalVolumes;    /**< @return the list of LVM PVs */
-    }
+    Q_DECL_DEPRECATED PhysicalVolumes& physicalVolumes();
     const PhysicalVolumes& physicalVolumes() const {
         return m_LVMPhysicalVolumes;    /**< @return the list of LVM PVs */
     }
@@ -90,6 +97,10 @@ public:
     }
 
     Device* findDeviceForPartition(const Partition* p);
+    Device* findDevice(const QString& deviceNode) const;
+    const Partition* findPhysicalVolume(const QString& partitionPath) const;
+    qint64 predictedBytesMoved() const;
+    PartitionSnapshot::Children snapshot(const Device& d, qint32 n) const;
 
     QReadWriteLock& lock() {
         return m_Lock;
@@ -99,6 +110,8 @@ protected:
     void clearDevices();
     void addDevice(Device* d);
     void sortDevices();
+    void setPhysicalVolumes(const PhysicalVolumes& pvs);
+    void addPhysicalVolumes(const PhysicalVolumes& pvs);
 
     bool mergeNewOperation(Operation*& currentOp, Operation*& pushedOp);
     bool mergeCopyOperation(Operation*& currentOp, Operation*& pushedOp);
@@ -106,12 +119,29 @@ protected:
     bool mergePartFlagsOperation(Operation*& currentOp, Operation*& pushedOp);
     bool mergePartLabelOperation(Operation*& currentOp, Operation*& pushedOp);
     bool mergeCreatePartitionTableOperation(Operation*& currentOp, Operation*& pushedOp);
+    bool mergeResizeOperation(Operation*& currentOp, Operation*& pushedOp);
+    bool mergeCheckOperation(Operation*& currentOp, Operation*& pushedOp);
+
+    bool targetedAfter(const Operation* op, const Partition& p) const;
+    bool targetedAfter(const Operation* op, const Device& d) const;
+
+    static qint64 bytesMoved(const Operation& op);
+
+    void appendSnapshot(const Operation* o);
+    void truncateSnapshots(qint32 n);
+    void resetSnapshots();
 
 private:
     Operations m_Operations;
     mutable Devices m_PreviewDevices;
     mutable PhysicalVolumes m_LVMPhysicalVolumes;
-    QReadWriteLock m_Lock;
+    QList<QHash<const Device*, PartitionSnapshot::Children>> m_Snapshots;
+    QHash<QString, Device*> m_DevicesByNode;
+    mutable QHash<const PartitionNode*, Device*> m_DevicesByTable;
+    mutable QHash<QString, const Partition*> m_PhysicalVolumesByPath;
+    mutable bool m_PhysicalVolumesIndexed;
+    mutable QMutex m_IndexMutex;
+    mutable QReadWriteLock m_Lock;
 };
 
 #endif
@@ -23,21 +23,39 @@
 
 #include "fs/filesystem.h"
 
+#include <algorithm>
+
+namespace
+{
+/** @return the index of the last Partition in the sorted list that starts at or before the given sector, -1 if there is none */
+int lastStartingAtOrBefore(const PartitionNode::Partitions& plist, qint64 s)
+{
+    const auto it = std::upper_bound(plist.begin(), plist.end(), s, [] (qint64 sector, const Partition* p) { return sector < p->firstSector(); });
+
+    return static_cast<int>(it - plist.begin()) - 1;
+}
+
+/** @return the index of the Partition in the sorted list, -1 if it is not in the list */
+int indexOf(const PartitionNode::Partitions& plist, const Partition& p)
+{
+    auto it = std::lower_bound(plist.begin(), plist.end(), p.firstSector(), [] (const Partition* q, qint64 sector) { return q->firstSector() < sector; });
+
+    for (; it != plist.end() && (*it)->firstSector() == p.firstSector(); ++it)
+        if (*it == &p)
+            return static_cast<int>(it - plist.begin());
+
+    // not where it should be: the Partition's sectors have been changed while it was in the list
+    return plist.indexOf(const_cast<Partition*>(&p));
+}
+}
+
 /** Tries to find the predecessor for a Partition.
     @param p the Partition to find a predecessor for
     @return pointer to the predecessor or nullptr if none was found
 */
 Partition* PartitionNode::predecessor(Partition& p)
 {
-    Q_ASSERT(p.parent());
-
-    Partitions& plist = p.parent()->isRoot() == false ? p.parent()->children() : children();
-
-    for (int idx = 1; idx < plist.size(); idx++)
-        if (plist[idx] == &p)
-            return plist[idx - 1];
-
-    return nullptr;
+    return const_cast<Partition*>(static_cast<const PartitionNode*>(this)->predecessor(p));
 }
 
 /**
@@ -48,12 +66,9 @@ const Partition* PartitionNode::predecessor(const Partition& p) const
     Q_ASSERT(p.parent());
 
     const Partitions& plist = p.parent()->isRoot() == false ? p.parent()->children() : children();
+    const int idx = indexOf(plist, p);
 
-    for (int idx = 1; idx < plist.size(); idx++)
-        if (plist[idx] == &p)
-            return plist[idx - 1];
-
-    return nullptr;
+    return idx > 0 ? plist[idx - 1] : nullptr;
 }
 
 /** Tries to find the successor for a Partition.
@@ -62,15 +77,7 @@ const Partition* PartitionNode::predecessor(const Partition& p) const
  */
 Partition* PartitionNode::successor(Partition& p)
 {
-    Q_ASSERT(p.parent());
-
-    Partitions& plist = p.parent()->isRoot() == false ? p.parent()->children() : children();
-
-    for (int idx = plist.size() - 2; idx >= 0; idx--)
-        if (plist[idx] == &p)
-            return plist[idx + 1];
-
-    return nullptr;
+    return const_cast<Partition*>(static_cast<const PartitionNode*>(this)->successor(p));
 }
 
 /**
@@ -81,12 +88,9 @@ const Partition* PartitionNode::successor(const Partition& p) const
     Q_ASSERT(p.parent());
 
     const Partitions& plist = p.parent()->isRoot() == false ? p.parent()->children() : children();
+    const int idx = indexOf(plist, p);
 
-    for (int idx = plist.size() - 2; idx >= 0; idx--)
-        if (plist[idx] == &p)
-            return plist[idx + 1];
-
-    return nullptr;
+    return idx >= 0 && idx < plist.size() - 1 ? plist[idx + 1] : nullptr;
 }
 
 /** Inserts a Partition into a PartitionNode's children
@@ -98,14 +102,7 @@ bool PartitionNode::insert(Partition* p)
     if (p == nullptr)
         return false;
 
-    for (int idx = 0; idx < children().size(); idx++) {
-        if (children()[idx]->firstSector() > p->firstSector()) {
-            children().insert(idx, p);
-            return true;
-        }
-    }
-
-    children().insert(children().size(), p);
+    children().insert(lastStartingAtOrBefore(children(), p->firstSector()) + 1, p);
 
     return true;
 }
@@ -119,7 +116,14 @@ bool PartitionNode::remove(Partition* p)
     if (p == nullptr)
         return false;
 
-    return children().removeOne(p);
+    const int idx = indexOf(children(), *p);
+
+    if (idx < 0)
+        return false;
+
+    children().removeAt(idx);
+
+    return true;
 }
 
 /** Deletes all children */
@@ -136,19 +140,7 @@ void PartitionNode::clearChildren()
 */
 Partition* PartitionNode::findPartitionBySector(qint64 s, const PartitionRole& role)
 {
-    const auto partitions = children();
-    for (auto &p : partitions) {
-        // (women and) children first. ;-)
-        const auto pChildren = p->children();
-        for (auto &child : pChildren)
-            if ((child->roles().roles() & role.roles()) && s >= child->firstSector() && s <= child->lastSector())
-                return child;
-
-        if ((p->roles().roles() & role.roles()) && s >= p->firstSector() && s <= p->lastSector())
-            return p;
-    }
-
-    return nullptr;
+    return const_cast<Partition*>(static_cast<const PartitionNode*>(this)->findPartitionBySector(s, role));
 }
 
 /**
@@ -156,15 +148,25 @@ Partition* PartitionNode::findPartitionBySector(qint64 s, const PartitionRole& r
 */
 const Partition* PartitionNode::findPartitionBySector(qint64 s, const PartitionRole& role) const
 {
-    for (const auto *p : children()) {
-        for (const auto &child : p->children())
-            if ((child->roles().roles() & role.roles()) && s >= child->firstSector() && s <= child->lastSector())
-                return child;
+    // children don't overlap, so only the last one starting before s can contain it
+    const int idx = lastStartingAtOrBefore(children(), s);
+
+    if (idx < 0 || s > children()[idx]->lastSector())
+        return nullptr;
 
-        if ((p->roles().roles() & role.roles()) && s >= p->firstSector() && s <= p->lastSector())
-            return p;
+    const Partition* p = children()[idx];
+
+    // (women and) children first. ;-)
+    const int childIdx = lastStartingAtOrBefore(p->children(), s);
+    if (childIdx >= 0) {
+        const Partition* child = p->children()[childIdx];
+        if ((child->roles().roles() & role.roles()) && s <= child->lastSector())
+            return child;
     }
 
+    if (p->roles().roles() & role.roles())
+        return p;
+
     return nullptr;
 }
 
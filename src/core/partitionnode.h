@@ -33,6 +33,10 @@ class PartitionRole;
     The root in this tree is the PartitionTable. The primaries are the child nodes; extended partitions again
     have child nodes.
 
+    Children are kept sorted by their first sector and do not overlap, so looking up a Partition by
+    sector and finding a Partition's neighbours are binary searches. Partitions whose sectors change
+    must be removed before and inserted again afterwards; append() must only be used in sector order.
+
     @see Device, PartitionTable, Partition
     @author Volker Lanz <vl@fidra.de>
 */
@@ -0,0 +1,89 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#include "core/partitionsnapshot.h"
+
+#include "core/partition.h"
+#include "core/partitionnode.h"
+
+#include <QHash>
+
+/** Creates a new PartitionSnapshot.
+    @param p the Partition to take a snapshot of
+    @param children the snapshots of the Partition's children
+*/
+PartitionSnapshot::PartitionSnapshot(const Partition& p, const Children& children) :
+    m_Partition(&p),
+    m_FirstSector(p.firstSector()),
+    m_LastSector(p.lastSector()),
+    m_Roles(p.roles()),
+    m_DeviceNode(p.deviceNode()),
+    m_FileSystemType(p.fileSystem().type()),
+    m_Label(p.fileSystem().label()),
+    m_ActiveFlags(p.activeFlags()),
+    m_Children(children)
+{
+}
+
+/** Takes snapshots of a PartitionNode's children.
+
+    Children that still match their entry in @p previous reuse that entry instead of getting a
+    new one.
+
+    @param node the PartitionNode to take snapshots of the children of
+    @param previous an earlier snapshot of the same PartitionNode's children
+    @return the snapshots of the children, in the same order
+*/
+PartitionSnapshot::Children PartitionSnapshot::take(const PartitionNode& node, const Children& previous)
+{
+    QHash<const Partition*, Pointer> previousByPartition;
+    previousByPartition.reserve(previous.size());
+    for (const auto &s : previous)
+        previousByPartition.insert(s->partition(), s);
+
+    Children rval;
+    rval.reserve(node.children().size());
+
+    for (const auto &p : node.children()) {
+        const Pointer old = previousByPartition.value(p);
+        const Children children = take(*p, old ? old->children() : Children());
+
+        if (old && old->matches(*p, children))
+            rval.append(old);
+        else
+            rval.append(Pointer(new PartitionSnapshot(*p, children)));
+    }
+
+    return rval;
+}
+
+/** @return true if this is a snapshot of the given Partition in its current state
+    @param p the Partition to compare with
+    @param children the current snapshots of the Partition's children
+*/
+bool PartitionSnapshot::matches(const Partition& p, const Children& children) const
+{
+    return m_Partition == &p &&
+           m_FirstSector == p.firstSector() &&
+           m_LastSector == p.lastSector() &&
+           m_Roles == p.roles() &&
+           m_DeviceNode == p.deviceNode() &&
+           m_FileSystemType == p.fileSystem().type() &&
+           m_Label == p.fileSystem().label() &&
+           m_ActiveFlags == p.activeFlags() &&
+           m_Children == children;
+}
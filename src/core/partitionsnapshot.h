@@ -0,0 +1,101 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#if !defined(PARTITIONSNAPSHOT__H)
+
+#define PARTITIONSNAPSHOT__H
+
+#include "core/partitionrole.h"
+#include "core/partitiontable.h"
+
+#include "fs/filesystem.h"
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+class Partition;
+class PartitionNode;
+
+/** An immutable copy of a Partition's layout at one point in time.
+
+    Snapshots of successive states of a PartitionNode share the entries of all Partitions that
+    did not change in between, so a series of snapshots only takes memory for what changed and
+    two snapshots can be compared by pointer.
+
+    @see OperationStack::snapshot()
+    @author Andrius Štikonas <andrius@stikonas.eu>
+*/
+class LIBKPMCORE_EXPORT PartitionSnapshot
+{
+public:
+    typedef QSharedPointer<const PartitionSnapshot> Pointer;
+    typedef QVector<Pointer> Children;
+
+protected:
+    PartitionSnapshot(const Partition& p, const Children& children);
+
+public:
+    static Children take(const PartitionNode& node, const Children& previous = Children());
+
+    const Partition* partition() const {
+        return m_Partition;    /**< @return the Partition this is a snapshot of; only for identification, it may no longer exist */
+    }
+    qint64 firstSector() const {
+        return m_FirstSector;    /**< @return the Partition's first sector */
+    }
+    qint64 lastSector() const {
+        return m_LastSector;    /**< @return the Partition's last sector */
+    }
+    const PartitionRole& roles() const {
+        return m_Roles;    /**< @return the Partition's roles */
+    }
+    const QString& deviceNode() const {
+        return m_DeviceNode;    /**< @return the Partition's device node */
+    }
+    FileSystem::Type fileSystemType() const {
+        return m_FileSystemType;    /**< @return the type of the Partition's FileSystem */
+    }
+    const QString& label() const {
+        return m_Label;    /**< @return the label of the Partition's FileSystem */
+    }
+    PartitionTable::Flags activeFlags() const {
+        return m_ActiveFlags;    /**< @return the Partition's active flags */
+    }
+    const Children& children() const {
+        return m_Children;    /**< @return snapshots of the Partition's children */
+    }
+
+protected:
+    bool matches(const Partition& p, const Children& children) const;
+
+private:
+    const Partition* m_Partition;
+    qint64 m_FirstSector;
+    qint64 m_LastSector;
+    PartitionRole m_Roles;
+    QString m_DeviceNode;
+    FileSystem::Type m_FileSystemType;
+    QString m_Label;
+    PartitionTable::Flags m_ActiveFlags;
+    Children m_Children;
+};
+
+#endif
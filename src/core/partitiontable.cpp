@@ -36,6 +36,8 @@
 #include <QDebug>
 #include <QTextStream>
 
+#include <algorithm>
+
 /** Creates a new PartitionTable object with type MSDOS
     @param type name of the PartitionTable type (e.g. "msdos" or "gpt")
 */
@@ -419,6 +421,71 @@ void PartitionTable::updateUnallocated(const Device& d)
     insertUnallocated(d, this, firstUsable());
 }
 
+/** Updates the unallocated Partitions next to a Partition that was just inserted or removed.
+
+    Free space only depends on a gap's two neighbours, so only the unallocated Partitions between
+    the closest allocated siblings before and after @p p are recreated, instead of all of them.
+    If @p p is an extended Partition, the unallocated Partitions inside it are recreated, too.
+
+    LVM devices rearrange all their LVs to keep the free space at the end and always get a full
+    update.
+
+    @param d the Device this PartitionTable is on
+    @param p the Partition that was inserted into or removed from its parent, with the sectors it had there
+*/
+void PartitionTable::updateUnallocated(const Device& d, Partition& p)
+{
+    if (d.type() == Device::LVM_Device || p.parent() == nullptr) {
+        updateUnallocated(d);
+        return;
+    }
+
+    PartitionNode& parent = *p.parent();
+    Partitions& plist = parent.children();
+    const qint64 first = p.firstSector();
+    const qint64 last = p.lastSector();
+
+    // closest allocated sibling entirely before p ...
+    int lo = static_cast<int>(std::upper_bound(plist.begin(), plist.end(), first, [] (qint64 s, const Partition* q) { return s < q->firstSector(); }) - plist.begin()) - 1;
+    while (lo >= 0 && (plist[lo]->roles().has(PartitionRole::Unallocated) || plist[lo]->lastSector() >= first))
+        lo--;
+
+    // ... and entirely after p
+    int hi = lo + 1;
+    while (hi < plist.size() && (plist[hi]->roles().has(PartitionRole::Unallocated) || plist[hi]->firstSector() <= last))
+        hi++;
+
+    Partition* right = hi < plist.size() ? plist[hi] : nullptr;
+    Partitions allocated;
+    for (int i = hi - 1; i > lo; i--) {
+        if (plist[i]->roles().has(PartitionRole::Unallocated))
+            delete plist.takeAt(i);
+        else
+            allocated.prepend(plist[i]);
+    }
+
+    const Partition* extended = parent.isRoot() ? nullptr : dynamic_cast<const Partition*>(&parent);
+    qint64 lastEnd = lo >= 0 ? plist[lo]->lastSector() + 1 : (extended ? extended->firstSector() : firstUsable());
+
+    for (const auto &child : allocated) {
+        parent.insert(createUnallocated(d, parent, lastEnd, child->firstSector() - 1));
+        lastEnd = child->lastSector() + 1;
+    }
+
+    if (right)
+        parent.insert(createUnallocated(d, parent, lastEnd, right->firstSector() - 1));
+    else {
+        const qint64 parentEnd = extended ? extended->lastSector() : lastUsable();
+        if (parentEnd >= firstUsable() && parentEnd >= lastEnd)
+            parent.insert(createUnallocated(d, parent, lastEnd, parentEnd));
+    }
+
+    if (p.roles().has(PartitionRole::Extended) && allocated.contains(&p)) {
+        removeUnallocated(&p);
+        insertUnallocated(d, &p, p.firstSector());
+    }
+}
+
 qint64 PartitionTable::defaultFirstUsable(const Device& d, TableType t)
 {
     Q_UNUSED(t)
@@ -161,6 +161,7 @@ public:
     }
 
     void updateUnallocated(const Device& d);
+    void updateUnallocated(const Device& d, Partition& p);
     void insertUnallocated(const Device& d, PartitionNode* p, qint64 start) const;
 
     bool isSectorBased(const Device& d) const;
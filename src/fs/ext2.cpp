@@ -96,28 +96,27 @@ qint64 ext2::readUsedCapacity(const QString& deviceNode) const
 {
     ExternalCommand cmd(QStringLiteral("dumpe2fs"), { QStringLiteral("-h"), deviceNode });
 
-    if (cmd.run()) {
-        qint64 blockCount = -1;
-        QRegularExpression re(QStringLiteral("Block count:\\s+(\\d+)"));
-        QRegularExpressionMatch reBlockCount = re.match(cmd.output());
-
-        if (reBlockCount.hasMatch())
-            blockCount = reBlockCount.captured(1).toLongLong();
-
-        qint64 freeBlocks = -1;
-        re.setPattern(QStringLiteral("Free blocks:\\s+(\\d+)"));
-        QRegularExpressionMatch reFreeBlocks = re.match(cmd.output());
-
-        if (reFreeBlocks.hasMatch())
-            freeBlocks = reFreeBlocks.captured(1).toLongLong();
-
-        qint64 blockSize = -1;
-        re.setPattern(QStringLiteral("Block size:\\s+(\\d+)"));
-        QRegularExpressionMatch reBlockSize = re.match(cmd.output());
-
-        if (reBlockSize.hasMatch())
-            blockSize = reBlockSize.captured(1).toLongLong();
+    qint64 blockCount = -1;
+    qint64 freeBlocks = -1;
+    qint64 blockSize = -1;
+
+    // match the header fields while dumpe2fs is still writing, nothing else needs to be kept
+    const QRegularExpression re(QStringLiteral("^(Block count|Free blocks|Block size):\\s+(\\d+)"));
+    cmd.setOutputLimit(0);
+    cmd.setLineHandler([&](const QString& line) {
+        QRegularExpressionMatch match = re.match(line);
+        if (!match.hasMatch())
+            return;
+
+        if (match.captured(1) == QStringLiteral("Block count"))
+            blockCount = match.captured(2).toLongLong();
+        else if (match.captured(1) == QStringLiteral("Free blocks"))
+            freeBlocks = match.captured(2).toLongLong();
+        else
+            blockSize = match.captured(2).toLongLong();
+    });
 
+    if (cmd.run()) {
         if (blockCount > -1 && freeBlocks > -1 && blockSize > -1)
             return (blockCount - freeBlocks) * blockSize;
     }
@@ -127,7 +126,21 @@ qint64 ext2::readUsedCapacity(const QString& deviceNode) const
 
 bool ext2::check(Report& report, const QString& deviceNode) const
 {
-    ExternalCommand cmd(report, QStringLiteral("e2fsck"), { QStringLiteral("-f"), QStringLiteral("-y"), QStringLiteral("-v"), deviceNode });
+    ExternalCommand cmd(report, QStringLiteral("e2fsck"), { QStringLiteral("-f"), QStringLiteral("-y"), QStringLiteral("-v"), QStringLiteral("-C"), QStringLiteral("1"), deviceNode });
+    cmd.setOutputLimit(256 * 1024); // a badly broken file system can produce a huge amount of output
+
+    // -C 1 makes e2fsck write "pass current max device" lines for its five passes to stdout
+    const QRegularExpression re(QStringLiteral("^([1-5]) (\\d+) (\\d+) \\S+$"));
+    cmd.setProgressDecoder([&re](const QString& line) {
+        QRegularExpressionMatch match = re.match(line);
+        if (!match.hasMatch())
+            return -1;
+
+        const qint64 max = match.captured(3).toLongLong();
+        const qint64 current = max > 0 ? qMin(match.captured(2).toLongLong(), max) : 0;
+        return static_cast<int>(((match.captured(1).toInt() - 1) * 100 + (max > 0 ? current * 100 / max : 0)) / 5);
+    });
+
     return cmd.run(-1) && (cmd.exitCode() == 0 || cmd.exitCode() == 1 || cmd.exitCode() == 2 || cmd.exitCode() == 256);
 }
 
@@ -141,7 +154,15 @@ bool ext2::resize(Report& report, const QString& deviceNode, qint64 length) cons
 {
     const QString len = QString::number(length / 512) + QStringLiteral("s");
 
-    ExternalCommand cmd(report, QStringLiteral("resize2fs"), { deviceNode, len });
+    ExternalCommand cmd(report, QStringLiteral("resize2fs"), { QStringLiteral("-p"), deviceNode, len });
+
+    // -p announces each of the (up to) four passes, the progress bars in between have no numbers
+    const QRegularExpression re(QStringLiteral("^Begin pass ([1-4])"));
+    cmd.setProgressDecoder([&re](const QString& line) {
+        QRegularExpressionMatch match = re.match(line);
+        return match.hasMatch() ? (match.captured(1).toInt() - 1) * 25 : -1;
+    });
+
     return cmd.run(-1) && cmd.exitCode() == 0;
 }
 
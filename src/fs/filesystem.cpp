@@ -24,15 +24,45 @@
 #include "backend/corebackendmanager.h"
 
 #include "util/externalcommand.h"
+#include "util/externalcommandqueue.h"
 #include "util/capacity.h"
 #include "util/helpers.h"
 
 #include <blkid/blkid.h>
+#include <sys/stat.h>
 
 #include <KMountPoint>
 #include <KLocalizedString>
 
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QVector>
+
+namespace
+{
+/** A tool that was found in PATH but has not been run yet */
+struct ToolCheck
+{
+    QString path;
+    QStringList args;
+    int expectedCode;
+    QString key;
+    QString stamp;
+};
+
+QMutex toolCacheMutex;
+QList<ToolCheck> pendingToolChecks;
+
+QString toolCacheFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/kpmcore/externaltools.ini");
+}
+}
 
 const std::array< QColor, FileSystem::__lastType > FileSystem::defaultColorCode =
 {
@@ -497,13 +527,90 @@ bool FileSystem::unmount(Report& report, const QString& deviceNode)
     return false;
 }
 
+/** Looks for an external tool.
+
+    The tool is looked up in PATH only. If an earlier run of the tool with the same arguments is
+    recorded in the on-disk cache and the binary has not changed since (same inode and mtime), its
+    result is used. Otherwise the tool is assumed to work and is queued to be run by
+    verifyExternalTools().
+
+    @param cmdName name of the tool
+    @param args arguments to run the tool with when verifying it
+    @param expectedCode exit code that counts as success besides 0
+    @return true if the tool is (assumed to be) usable
+*/
 bool FileSystem::findExternal(const QString& cmdName, const QStringList& args, int expectedCode)
 {
-    ExternalCommand cmd(cmdName, args);
-    if (!cmd.run())
+    const QString path = QStandardPaths::findExecutable(cmdName);
+    if (path.isEmpty())
+        return false;
+
+    struct stat st;
+    if (stat(QFile::encodeName(path).constData(), &st) != 0)
         return false;
 
-    return cmd.exitCode() == 0 || cmd.exitCode() == expectedCode;
+    const QString stamp = QString::number(st.st_ino) + QLatin1Char(':') + QString::number(st.st_mtime);
+    const QString key = QString::fromLatin1(QCryptographicHash::hash((path + QLatin1Char('\0') + args.join(QLatin1Char('\0')) + QLatin1Char('\0') + QString::number(expectedCode)).toUtf8(),
+                                                                     QCryptographicHash::Sha1).toHex());
+
+    QMutexLocker locker(&toolCacheMutex);
+
+    QSettings cache(toolCacheFileName(), QSettings::IniFormat);
+    const QStringList entry = cache.value(key).toStringList();
+    if (entry.size() == 2 && entry[0] == stamp)
+        return entry[1] == QStringLiteral("1");
+
+    for (const auto &check : pendingToolChecks)
+        if (check.key == key)
+            return true;
+
+    pendingToolChecks.append(ToolCheck{ path, args, expectedCode, key, stamp });
+    return true;
+}
+
+/** Runs all tools queued by findExternal() in parallel and records the results in the on-disk cache.
+    @return true if a tool that was assumed to work turned out not to
+*/
+bool FileSystem::verifyExternalTools()
+{
+    QList<ToolCheck> checks;
+    {
+        QMutexLocker locker(&toolCacheMutex);
+        checks.swap(pendingToolChecks);
+    }
+
+    if (checks.isEmpty())
+        return false;
+
+    QVector<bool> results(checks.size(), false);
+    QVector<bool> finished(checks.size(), false);
+    {
+        ExternalCommandQueue queue;
+        for (int i = 0; i < checks.size(); i++) {
+            const int expectedCode = checks[i].expectedCode;
+            queue.enqueue(new ExternalCommand(checks[i].path, checks[i].args), [&results, &finished, i, expectedCode](ExternalCommand& cmd) {
+                results[i] = cmd.exitCode() == 0 || cmd.exitCode() == expectedCode;
+                finished[i] = true;
+            });
+        }
+        queue.waitForAll(30000);
+    }
+
+    bool changed = false;
+
+    QMutexLocker locker(&toolCacheMutex);
+    QSettings cache(toolCacheFileName(), QSettings::IniFormat);
+    for (int i = 0; i < checks.size(); i++) {
+        // a tool that was too slow to answer in time is not known to be broken; probe it again next time
+        if (!finished[i])
+            continue;
+
+        cache.setValue(checks[i].key, QStringList() << checks[i].stamp << (results[i] ? QStringLiteral("1") : QStringLiteral("0")));
+        if (!results[i])
+            changed = true;
+    }
+
+    return changed;
 }
 
 bool FileSystem::supportToolFound() const
@@ -240,6 +240,8 @@ public:
         m_UUID = s;    /**< @param s the new UUID */
     }
 
+    static bool verifyExternalTools();
+
 protected:
     static bool findExternal(const QString& cmdName, const QStringList& args = QStringList(), int exptectedCode = 1);
 
@@ -90,6 +90,21 @@ void FileSystemFactory::init()
     CoreBackendManager::self()->backend()->initFSSupport();
 }
 
+/** Runs the external tools that were only looked up in PATH by init() and updates the
+    supported operations if any of them does not work.
+*/
+void FileSystemFactory::verifyTools()
+{
+    if (!FileSystem::verifyExternalTools())
+        return;
+
+    // the verified results are in the tool cache now, so this does not run anything
+    for (const auto &fs : FileSystemFactory::map())
+        fs->init();
+
+    CoreBackendManager::self()->backend()->initFSSupport();
+}
+
 /** Creates a new FileSystem
     @param t the FileSystem's type
     @param firstsector the FileSystem's first sector relative to the Device
@@ -23,6 +23,7 @@
 #include "util/externalcommand.h"
 #include "util/capacity.h"
 
+#include <QRegularExpression>
 #include <QString>
 
 #include <KLocalizedString>
@@ -142,11 +143,18 @@ bool lvm2_pv::resize(Report& report, const QString& deviceNode, qint64 length) c
             ExternalCommand moveCmd(report,
                                     QStringLiteral("lvm"), {
                                     QStringLiteral("pvmove"),
+                                    QStringLiteral("--interval"),
+                                    QStringLiteral("5"),
                                     QStringLiteral("--alloc"),
                                     QStringLiteral("anywhere"),
                                     deviceNode + QStringLiteral(":") + QString::number(firstMovedPE) + QStringLiteral("-") + QString::number(lastPE),
                                     deviceNode + QStringLiteral(":") + QStringLiteral("0-") + QString::number(firstMovedPE - 1)
                                     });
+            moveCmd.setProgressDecoder([](const QString& line) {
+                static const QRegularExpression re(QStringLiteral("Moved:\\s*([0-9.]+)%"));
+                QRegularExpressionMatch match = re.match(line);
+                return match.hasMatch() ? static_cast<int>(match.captured(1).toDouble()) : -1;
+            });
             rval = moveCmd.run(-1) && (moveCmd.exitCode() == 0 || moveCmd.exitCode() == 5); // FIXME: exit code 5: NO data to move
         }
     }
@@ -258,6 +266,39 @@ qint64 lvm2_pv::getAllocatedPE(const QStringList& deviceNodeList)
     return sum;
 }
 
+/** Get allocated PE ranges of a PV
+ *
+ *  @param deviceNode path to PV
+ *  @return list of (first PE, PE count) pairs of all segments that are not free
+ */
+QList<QPair<qint64, qint64>> lvm2_pv::getAllocatedSegments(const QString& deviceNode)
+{
+    QList<QPair<qint64, qint64>> segments;
+
+    ExternalCommand cmd(QStringLiteral("lvm"),
+                        { QStringLiteral("pvs"),
+                          QStringLiteral("--foreign"),
+                          QStringLiteral("--readonly"),
+                          QStringLiteral("--noheadings"),
+                          QStringLiteral("--segments"),
+                          QStringLiteral("--separator"),
+                          QStringLiteral(":"),
+                          QStringLiteral("--options"),
+                          QStringLiteral("pvseg_start,pvseg_size,segtype"),
+                          deviceNode });
+    if (!cmd.run(-1) || cmd.exitCode() != 0)
+        return segments;
+
+    for (const auto &line : cmd.output().split(QStringLiteral("\n"), QString::SkipEmptyParts)) {
+        const QStringList fields = line.trimmed().split(QStringLiteral(":"));
+        if (fields.size() < 3 || fields[2] == QStringLiteral("free"))
+            continue;
+        segments.append(QPair<qint64, qint64>(fields[0].toLongLong(), fields[1].toLongLong()));
+    }
+
+    return segments;
+}
+
 qint64 lvm2_pv::getPVSize(const QString& deviceNode)
 {
     QString val = getpvField(QStringLiteral("pv_size"), deviceNode);
@@ -113,6 +113,7 @@ public:
     static qint64 getFreePE(const QStringList& deviceNodeList);
     static qint64 getAllocatedPE(const QString& deviceNode);
     static qint64 getAllocatedPE(const QStringList& deviceNodeList);
+    static QList<QPair<qint64, qint64>> getAllocatedSegments(const QString& deviceNode); // (first PE, PE count) pairs
     void getPESize(const QString& deviceNode); // return PE size in bytes
     static qint64 getPVSize(const QString& deviceNode); // return PV size in bytes
     static qint64 getPVSize(const QStringList& deviceNodeList);
@@ -36,6 +36,14 @@
 
 namespace FS
 {
+/** @return the percentage from a "12.34 percent completed" progress line of the ntfsprogs, -1 for other lines */
+static int ntfsProgress(const QString& line)
+{
+    static const QRegularExpression re(QStringLiteral("(\\d+(?:\\.\\d+)?) percent completed"));
+    QRegularExpressionMatch match = re.match(line);
+    return match.hasMatch() ? static_cast<int>(match.captured(1).toDouble()) : -1;
+}
+
 FileSystem::CommandSupportType ntfs::m_GetUsed = FileSystem::cmdSupportNone;
 FileSystem::CommandSupportType ntfs::m_GetLabel = FileSystem::cmdSupportNone;
 FileSystem::CommandSupportType ntfs::m_Create = FileSystem::cmdSupportNone;
@@ -149,20 +157,22 @@ bool ntfs::create(Report& report, const QString& deviceNode)
 bool ntfs::copy(Report& report, const QString& targetDeviceNode, const QString& sourceDeviceNode) const
 {
     ExternalCommand cmd(report, QStringLiteral("ntfsclone"), { QStringLiteral("--force"), QStringLiteral("--overwrite"), targetDeviceNode, sourceDeviceNode });
+    cmd.setProgressDecoder(ntfsProgress);
 
     return cmd.run(-1) && cmd.exitCode() == 0;
 }
 
 bool ntfs::resize(Report& report, const QString& deviceNode, qint64 length) const
 {
-    QStringList args = { QStringLiteral("--no-progress-bar"), QStringLiteral("--force"), deviceNode, QStringLiteral("--size"), QString::number(length) };
+    QStringList args = { QStringLiteral("--force"), deviceNode, QStringLiteral("--size"), QString::number(length) };
 
     QStringList dryRunArgs = args;
-    dryRunArgs << QStringLiteral("--no-action");
+    dryRunArgs << QStringLiteral("--no-progress-bar") << QStringLiteral("--no-action");
     ExternalCommand cmdDryRun(QStringLiteral("ntfsresize"), dryRunArgs);
 
     if (cmdDryRun.run(-1) && cmdDryRun.exitCode() == 0) {
         ExternalCommand cmd(report, QStringLiteral("ntfsresize"), args);
+        cmd.setProgressDecoder(ntfsProgress);
         return cmd.run(-1) && cmd.exitCode() == 0;
     }
 
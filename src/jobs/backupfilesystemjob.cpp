@@ -22,6 +22,7 @@
 #include "core/device.h"
 #include "core/copysourcedevice.h"
 #include "core/copytargetfile.h"
+#include "core/durationestimator.h"
 
 #include "fs/filesystem.h"
 
@@ -72,6 +73,11 @@ bool BackupFileSystemJob::run(Report& parent)
     return rval;
 }
 
+qint64 BackupFileSystemJob::estimatedDuration() const
+{
+    return DurationEstimator::copyDuration(&sourceDevice(), nullptr, sourcePartition().fileSystem().length() * sourceDevice().logicalSize());
+}
+
 QString BackupFileSystemJob::description() const
 {
     return xi18nc("@info:progress", "Back up file system on partition <filename>%1</filename> to <filename>%2</filename>", sourcePartition().deviceNode(), fileName());
@@ -19,13 +19,31 @@
 #include "jobs/checkfilesystemjob.h"
 
 #include "core/partition.h"
+#include "core/durationestimator.h"
 
 #include "fs/filesystem.h"
 
 #include "util/report.h"
 
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
 #include <KLocalizedString>
 
+namespace
+{
+/** Amount of data at the start of a file system hashed to detect changes. This covers the
+    superblocks of all supported file systems, e.g. btrfs' at 64 KiB. */
+const qint64 markerSize = 128 * 1024;
+
+QMutex checkedMutex;
+QHash<QString, QByteArray> checkedFileSystems;
+}
+
 /** Creates a new CheckFileSystemJob
     @param p the Partition whose FileSystem is to be checked
 */
@@ -35,6 +53,11 @@ CheckFileSystemJob::CheckFileSystemJob(Partition& p) :
 {
 }
 
+qint32 CheckFileSystemJob::numSteps() const
+{
+    return 100;
+}
+
 bool CheckFileSystemJob::run(Report& parent)
 {
     Report* report = jobStarted(parent);
@@ -42,14 +65,80 @@ bool CheckFileSystemJob::run(Report& parent)
     // if we cannot check, assume everything is fine
     bool rval = true;
 
-    if (partition().fileSystem().supportCheck() == FileSystem::cmdSupportFileSystem)
-        rval = partition().fileSystem().check(*report, partition().deviceNode());
+    if (partition().fileSystem().supportCheck() == FileSystem::cmdSupportFileSystem) {
+        // a mounted file system may be written to at any time
+        const QByteArray marker = partition().isMounted() ? QByteArray() : changeMarker();
+
+        bool unchanged = false;
+        if (!marker.isEmpty()) {
+            QMutexLocker locker(&checkedMutex);
+            unchanged = checkedFileSystems.value(cacheKey()) == marker;
+        }
+
+        if (unchanged)
+            report->line() << xi18nc("@info:progress", "The file system on partition <filename>%1</filename> has not changed since it was last checked.", partition().deviceNode());
+        else {
+            QElapsedTimer timer;
+            timer.start();
+
+            rval = partition().fileSystem().check(*report, partition().deviceNode());
+
+            if (rval) {
+                DurationEstimator::recordTool(DurationEstimator::Check, partition(), timer.elapsed());
+
+                // the check may have repaired something, so look again
+                const QByteArray checkedMarker = marker.isEmpty() ? QByteArray() : changeMarker();
+                if (!checkedMarker.isEmpty()) {
+                    QMutexLocker locker(&checkedMutex);
+                    checkedFileSystems.insert(cacheKey(), checkedMarker);
+                }
+            }
+        }
+    }
 
     jobFinished(*report, rval);
 
     return rval;
 }
 
+qint64 CheckFileSystemJob::estimatedDuration() const
+{
+    if (partition().fileSystem().supportCheck() != FileSystem::cmdSupportFileSystem)
+        return Job::estimatedDuration();
+
+    return DurationEstimator::toolDuration(DurationEstimator::Check, partition());
+}
+
+/** Forgets all file systems that have been checked successfully. */
+void CheckFileSystemJob::clearCheckedCache()
+{
+    QMutexLocker locker(&checkedMutex);
+    checkedFileSystems.clear();
+}
+
+/** @return the key identifying the FileSystem in the cache of checked file systems */
+QString CheckFileSystemJob::cacheKey() const
+{
+    return partition().deviceNode() + QLatin1Char(':') + QString::number(partition().fileSystem().firstSector()) +
+           QLatin1Char(':') + QString::number(partition().fileSystem().lastSector()) + QLatin1Char(':') + QString::number(partition().fileSystem().type());
+}
+
+/** @return a hash of the FileSystem's first blocks, or an empty QByteArray if they cannot be read */
+QByteArray CheckFileSystemJob::changeMarker() const
+{
+    QFile device(partition().deviceNode());
+
+    if (!device.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+        return QByteArray();
+
+    const QByteArray head = device.read(markerSize);
+
+    if (head.isEmpty())
+        return QByteArray();
+
+    return QCryptographicHash::hash(head, QCryptographicHash::Sha1);
+}
+
 QString CheckFileSystemJob::description() const
 {
     return xi18nc("@info:progress", "Check file system on partition <filename>%1</filename>", partition().deviceNode());
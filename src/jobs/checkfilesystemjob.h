@@ -24,9 +24,16 @@
 class Partition;
 class Report;
 
+class QByteArray;
 class QString;
 
 /** Check a FileSystem.
+
+    Successful checks are remembered together with a hash of the FileSystem's first blocks,
+    where file systems keep their superblock with its write time, mount count or generation.
+    As long as these blocks have not changed, checking the same FileSystem again is skipped.
+    The OperationRunner forgets all checks when it starts running.
+
     @author Volker Lanz <vl@fidra.de>
 */
 class CheckFileSystemJob : public Job
@@ -36,8 +43,12 @@ public:
 
 public:
     bool run(Report& parent) override;
+    qint32 numSteps() const override;
+    qint64 estimatedDuration() const override;
     QString description() const override;
 
+    static void clearCheckedCache();
+
 protected:
     Partition& partition() {
         return m_Partition;
@@ -46,6 +57,9 @@ protected:
         return m_Partition;
     }
 
+    QString cacheKey() const;
+    QByteArray changeMarker() const;
+
 private:
     Partition& m_Partition;
 };
@@ -22,6 +22,8 @@
 #include "core/device.h"
 #include "core/copysourcedevice.h"
 #include "core/copytargetdevice.h"
+#include "core/lvmdevice.h"
+#include "core/durationestimator.h"
 
 #include "fs/filesystem.h"
 
@@ -40,10 +42,26 @@ CopyFileSystemJob::CopyFileSystemJob(Device& targetdevice, Partition& targetpart
     m_TargetDevice(targetdevice),
     m_TargetPartition(targetpartition),
     m_SourceDevice(sourcedevice),
-    m_SourcePartition(sourcepartition)
+    m_SourcePartition(sourcepartition),
+    m_CloneBySnapshot(false)
 {
 }
 
+/** @return true if the source is a thin LV and the target is a new LV in the same VG that is not smaller */
+bool CopyFileSystemJob::canCloneBySnapshot() const
+{
+    if (sourceDevice().type() != Device::LVM_Device || targetDevice().type() != Device::LVM_Device)
+        return false;
+
+    if (sourceDevice().deviceNode() != targetDevice().deviceNode())
+        return false;
+
+    if (targetPartition().length() < sourcePartition().length())
+        return false;
+
+    return !LvmDevice::getThinPool(sourcePartition().partitionPath()).isEmpty();
+}
+
 qint32 CopyFileSystemJob::numSteps() const
 {
     return 100;
@@ -57,6 +75,14 @@ bool CopyFileSystemJob::run(Report& parent)
 
     if (targetPartition().fileSystem().length() < sourcePartition().fileSystem().length())
         report->line() << xi18nc("@info:progress", "Cannot copy file system: File system on target partition <filename>%1</filename> is smaller than the file system on source partition <filename>%2</filename>.", targetPartition().deviceNode(), sourcePartition().deviceNode());
+    else if (cloneBySnapshot()) {
+        const QString partPath = targetPartition().partitionPath();
+        const QString lvName = partPath.right(partPath.length() - partPath.lastIndexOf(QStringLiteral("/")) - 1);
+
+        rval = LvmDevice::cloneThinLV(*report, dynamic_cast<LvmDevice&>(targetDevice()), sourcePartition(), targetPartition(), lvName);
+        if (!rval)
+            report->line() << xi18nc("@info:progress", "Could not create thin snapshot <filename>%1</filename> of <filename>%2</filename>.", partPath, sourcePartition().partitionPath());
+    }
     else if (sourcePartition().fileSystem().supportCopy() == FileSystem::cmdSupportFileSystem)
         rval = sourcePartition().fileSystem().copy(*report, targetPartition().deviceNode(), sourcePartition().deviceNode());
     else if (sourcePartition().fileSystem().supportCopy() == FileSystem::cmdSupportCore) {
@@ -94,6 +120,14 @@ bool CopyFileSystemJob::run(Report& parent)
     return rval;
 }
 
+qint64 CopyFileSystemJob::estimatedDuration() const
+{
+    if (cloneBySnapshot())
+        return Job::estimatedDuration();
+
+    return DurationEstimator::copyDuration(&sourceDevice(), &targetDevice(), sourcePartition().fileSystem().length() * sourceDevice().logicalSize());
+}
+
 QString CopyFileSystemJob::description() const
 {
     return xi18nc("@info:progress", "Copy file system on partition <filename>%1</filename> to partition <filename>%2</filename>", sourcePartition().deviceNode(), targetPartition().deviceNode());
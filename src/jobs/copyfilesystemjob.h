@@ -33,6 +33,9 @@ class QString;
 
     Copy a FileSystem on a given Partition and Device to another Partition on a (possibly other) Device.
 
+    A thin LVM LV can instead be cloned as a thin snapshot in the same VG, which only
+    writes metadata. The caller must then not create the target LV itself.
+
     @author Volker Lanz <vl@fidra.de>
 */
 class CopyFileSystemJob : public Job
@@ -43,8 +46,18 @@ public:
 public:
     bool run(Report& parent) override;
     qint32 numSteps() const override;
+    qint64 estimatedDuration() const override;
     QString description() const override;
 
+    bool canCloneBySnapshot() const;
+
+    bool cloneBySnapshot() const {
+        return m_CloneBySnapshot;    /**< @return true if the target LV is created as a thin snapshot of the source */
+    }
+    void setCloneBySnapshot(bool b) {
+        m_CloneBySnapshot = b;    /**< @param b true to create the target LV as a thin snapshot of the source */
+    }
+
 protected:
     Partition& targetPartition() {
         return m_TargetPartition;
@@ -79,6 +92,7 @@ private:
     Partition& m_TargetPartition;
     Device& m_SourceDevice;
     Partition& m_SourcePartition;
+    bool m_CloneBySnapshot;
 };
 
 #endif
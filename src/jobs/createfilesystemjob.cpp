@@ -22,14 +22,18 @@
 #include "backend/corebackendmanager.h"
 #include "backend/corebackenddevice.h"
 #include "backend/corebackendpartitiontable.h"
+#include "backend/partitiontabletransaction.h"
 
 #include "core/device.h"
 #include "core/partition.h"
+#include "core/durationestimator.h"
 
 #include "fs/filesystem.h"
 
 #include "util/report.h"
 
+#include <QElapsedTimer>
+
 #include <KLocalizedString>
 
 /** Creates a new CreateFileSystemJob
@@ -52,25 +56,26 @@ bool CreateFileSystemJob::run(Report& parent)
         return true;
 
     if (partition().fileSystem().supportCreate() == FileSystem::cmdSupportFileSystem) {
+        QElapsedTimer timer;
+        timer.start();
+
         if (partition().fileSystem().create(*report, partition().deviceNode())) {
+            DurationEstimator::recordTool(DurationEstimator::Create, partition(), timer.elapsed());
+
             if (device().type() == Device::Disk_Device) {
-                CoreBackendDevice* backendDevice = CoreBackendManager::self()->backend()->openDevice(device().deviceNode());
+                PartitionTableTransaction::Edit edit(device().deviceNode());
 
-                if (backendDevice) {
-                    CoreBackendPartitionTable* backendPartitionTable = backendDevice->openPartitionTable();
+                if (edit.backendDevice()) {
+                    CoreBackendPartitionTable* backendPartitionTable = edit.backendPartitionTable();
 
                     if (backendPartitionTable) {
                         if (backendPartitionTable->setPartitionSystemType(*report, partition())) {
                             rval = true;
-                            backendPartitionTable->commit();
+                            edit.commit();
                         } else
                             report->line() << xi18nc("@info:progress", "Failed to set the system type for the file system on partition <filename>%1</filename>.", partition().deviceNode());
-
-                        delete backendPartitionTable;
                     } else
                         report->line() << xi18nc("@info:progress", "Could not open partition table on device <filename>%1</filename> to set the system type for partition <filename>%2</filename>.", device().deviceNode(), partition().deviceNode());
-
-                    delete backendDevice;
                 } else
                     report->line() << xi18nc("@info:progress", "Could not open device <filename>%1</filename> to set the system type for partition <filename>%2</filename>.", device().deviceNode(), partition().deviceNode());
             } else if (device().type() == Device::LVM_Device) {
@@ -84,6 +89,14 @@ bool CreateFileSystemJob::run(Report& parent)
     return rval;
 }
 
+qint64 CreateFileSystemJob::estimatedDuration() const
+{
+    if (partition().fileSystem().supportCreate() != FileSystem::cmdSupportFileSystem)
+        return Job::estimatedDuration();
+
+    return DurationEstimator::toolDuration(DurationEstimator::Create, partition());
+}
+
 QString CreateFileSystemJob::description() const
 {
     return xi18nc("@info:progress", "Create file system <filename>%1</filename> on partition <filename>%2</filename>", partition().fileSystem().name(), partition().deviceNode());
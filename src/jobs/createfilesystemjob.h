@@ -37,6 +37,7 @@ public:
 
 public:
     bool run(Report& parent) override;
+    qint64 estimatedDuration() const override;
     QString description() const override;
 
 protected:
@@ -22,6 +22,7 @@
 #include "backend/corebackendmanager.h"
 #include "backend/corebackenddevice.h"
 #include "backend/corebackendpartitiontable.h"
+#include "backend/partitiontabletransaction.h"
 
 #include "core/partition.h"
 #include "core/device.h"
@@ -51,10 +52,10 @@ bool CreatePartitionJob::run(Report& parent)
     Report* report = jobStarted(parent);
 
     if (device().type() == Device::Disk_Device) {
-        CoreBackendDevice* backendDevice = CoreBackendManager::self()->backend()->openDevice(device().deviceNode());
+        PartitionTableTransaction::Edit edit(device().deviceNode());
 
-        if (backendDevice) {
-            CoreBackendPartitionTable* backendPartitionTable = backendDevice->openPartitionTable();
+        if (edit.backendDevice()) {
+            CoreBackendPartitionTable* backendPartitionTable = edit.backendPartitionTable();
 
             if (backendPartitionTable) {
                 QString partitionPath = backendPartitionTable->createPartition(*report, partition());
@@ -63,15 +64,11 @@ bool CreatePartitionJob::run(Report& parent)
                     rval = true;
                     partition().setPartitionPath(partitionPath);
                     partition().setState(Partition::StateNone);
-                    backendPartitionTable->commit();
+                    edit.commit();
                 } else
                     report->line() << xi18nc("@info/plain", "Failed to add partition <filename>%1</filename> to device <filename>%2</filename>.", partition().deviceNode(), device().deviceNode());
-
-                delete backendPartitionTable;
             } else
                 report->line() << xi18nc("@info:progress", "Could not open partition table on device <filename>%1</filename> to create new partition <filename>%2</filename>.", device().deviceNode(), partition().deviceNode());
-
-            delete backendDevice;
         } else
             report->line() << xi18nc("@info:progress", "Could not open device <filename>%1</filename> to create new partition <filename>%2</filename>.", device().deviceNode(), partition().deviceNode());
     } else if (device().type() == Device::LVM_Device) {
@@ -45,6 +45,7 @@ bool CreatePartitionTableJob::run(Report& parent)
     Report* report = jobStarted(parent);
 
     if (device().type() == Device::Disk_Device) {
+        QMutexLocker backendLocker(&CoreBackendManager::self()->mutex());
         CoreBackendDevice* backendDevice = CoreBackendManager::self()->backend()->openDevice(device().deviceNode());
 
         if (backendDevice != nullptr) {
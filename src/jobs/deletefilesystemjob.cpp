@@ -22,6 +22,7 @@
 #include "backend/corebackendmanager.h"
 #include "backend/corebackenddevice.h"
 #include "backend/corebackendpartitiontable.h"
+#include "backend/partitiontabletransaction.h"
 
 #include "core/partition.h"
 #include "core/device.h"
@@ -74,10 +75,10 @@ bool DeleteFileSystemJob::run(Report& parent)
             return false;
         }
 
-        CoreBackendDevice* backendDevice = CoreBackendManager::self()->backend()->openDevice(device().deviceNode());
+        PartitionTableTransaction::Edit edit(device().deviceNode());
 
-        if (backendDevice) {
-            CoreBackendPartitionTable* backendPartitionTable = backendDevice->openPartitionTable();
+        if (edit.backendDevice()) {
+            CoreBackendPartitionTable* backendPartitionTable = edit.backendPartitionTable();
 
             if (backendPartitionTable) {
                 rval = backendPartitionTable->clobberFileSystem(*report, partition());
@@ -85,14 +86,9 @@ bool DeleteFileSystemJob::run(Report& parent)
                 if (!rval)
                     report->line() << xi18nc("@info:progress", "Could not delete file system on <filename>%1</filename>.", partition().deviceNode());
                 else
-                    backendPartitionTable->commit();
-
-                delete backendPartitionTable;
-
+                    edit.commit();
             } else
                 report->line() << xi18nc("@info:progress", "Could not open partition table on device <filename>%1</filename> to delete file system on <filename>%2</filename>.", device().deviceNode(), partition().deviceNode());
-
-            delete backendDevice;
         } else
             report->line() << xi18nc("@info:progress", "Could not delete file system signature for partition <filename>%1</filename>: Failed to open device <filename>%2</filename>.", partition().deviceNode(), device().deviceNode());
     }
@@ -22,6 +22,7 @@
 #include "backend/corebackendmanager.h"
 #include "backend/corebackenddevice.h"
 #include "backend/corebackendpartitiontable.h"
+#include "backend/partitiontabletransaction.h"
 
 #include "core/partition.h"
 #include "core/device.h"
@@ -58,10 +59,10 @@ bool DeletePartitionJob::run(Report& parent)
     Report* report = jobStarted(parent);
 
     if (device().type() == Device::Disk_Device) {
-        CoreBackendDevice* backendDevice = CoreBackendManager::self()->backend()->openDevice(device().deviceNode());
+        PartitionTableTransaction::Edit edit(device().deviceNode());
 
-        if (backendDevice) {
-            CoreBackendPartitionTable* backendPartitionTable = backendDevice->openPartitionTable();
+        if (edit.backendDevice()) {
+            CoreBackendPartitionTable* backendPartitionTable = edit.backendPartitionTable();
 
             if (backendPartitionTable) {
                 rval = backendPartitionTable->deletePartition(*report, partition());
@@ -69,14 +70,9 @@ bool DeletePartitionJob::run(Report& parent)
                 if (!rval)
                     report->line() << xi18nc("@info:progress", "Could not delete partition <filename>%1</filename>.", partition().deviceNode());
                 else
-                    backendPartitionTable->commit();
-
-                delete backendPartitionTable;
-
+                    edit.commit();
             } else
                 report->line() << xi18nc("@info:progress", "Could not open partition table on device <filename>%1</filename> to delete partition <filename>%2</filename>.", device().deviceNode(), partition().deviceNode());
-
-            delete backendDevice;
         } else
             report->line() << xi18nc("@info:progress", "Deleting partition failed: Could not open device <filename>%1</filename>.", device().deviceNode());
     } else if (device().type() == Device::LVM_Device) {
@@ -23,10 +23,12 @@
 #include "core/copytarget.h"
 #include "core/copysourcedevice.h"
 #include "core/copytargetdevice.h"
+#include "core/durationestimator.h"
 
 #include "util/report.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QIcon>
 #include <QTime>
 
@@ -70,12 +72,20 @@ bool Job::copyBlocks(Report& report, CopyTarget& target, CopySource& source)
     QTime t;
     t.start();
 
+    // time reads and writes separately to learn each device's throughput
+    QElapsedTimer ioTimer;
+    qint64 readMsecs = 0;
+    qint64 writeMsecs = 0;
+
     while (blocksCopied < blocksToCopy) {
+        ioTimer.start();
         if (!(rval = source.readSectors(buffer, readOffset + blockSize * blocksCopied * copyDir, blockSize)))
             break;
+        readMsecs += ioTimer.restart();
 
         if (!(rval = target.writeSectors(buffer, writeOffset + blockSize * blocksCopied * copyDir, blockSize)))
             break;
+        writeMsecs += ioTimer.elapsed();
 
         if (++blocksCopied * 100 / blocksToCopy != percent) {
             percent = blocksCopied * 100 / blocksToCopy;
@@ -111,6 +121,15 @@ bool Job::copyBlocks(Report& report, CopyTarget& target, CopySource& source)
 
     free(buffer);
 
+    if (rval) {
+        const CopySourceDevice* sourceDevice = dynamic_cast<const CopySourceDevice*>(&source);
+        const CopyTargetDevice* targetDevice = dynamic_cast<const CopyTargetDevice*>(&target);
+
+        DurationEstimator::recordCopy(sourceDevice ? &sourceDevice->device() : nullptr, readMsecs,
+                                      targetDevice ? &targetDevice->device() : nullptr, writeMsecs,
+                                      blocksCopied * blockSize * source.sectorSize());
+    }
+
     report.line() << xi18ncp("@info:progress argument 2 is a string such as 7 sectors (localized accordingly)", "Copying 1 block (%2) finished.", "Copying %1 blocks (%2) finished.", blocksCopied, i18np("1 sector", "%1 sectors", target.sectorsWritten()));
 
     return rval;
@@ -171,11 +190,35 @@ void Job::emitProgress(int i)
     emit progress(i);
 }
 
+/** Marks a Job its Operation decided not to run as successfully finished, so that its steps
+    are counted as done.
+    @param parent the parent Report to add a new child to for this Job
+*/
+void Job::skip(Report& parent)
+{
+    Report* report = jobStarted(parent);
+    report->line() << xi18nc("@info:progress", "Not needed, skipped.");
+    jobFinished(*report, true);
+}
+
 Report* Job::jobStarted(Report& parent)
 {
     emit started();
 
-    return parent.newChild(xi18nc("@info:progress", "Job: %1", description()));
+    Report* report = parent.newChild(xi18nc("@info:progress", "Job: %1", description()));
+
+    // external commands run by this job report their progress through the Report
+    connect(report, &Report::progressChanged, this, &Job::onReportProgress);
+
+    return report;
+}
+
+/** Forwards the progress of an external command run by this job.
+    @param percent the progress of the command in percent
+*/
+void Job::onReportProgress(int percent)
+{
+    emitProgress(percent * numSteps() / 100);
 }
 
 void Job::jobFinished(Report& report, bool b)
@@ -70,6 +70,12 @@ public:
     virtual qint32 numSteps() const {
         return 1;    /**< @return the number of steps the job takes to complete */
     }
+    virtual qint64 estimatedDuration() const {
+        return 1000;    /**< @return the predicted run time in milliseconds */
+    }
+    virtual bool needsDeviceNodes() const {
+        return true;    /**< @return false if the Job only edits a partition table and can run before earlier edits are committed */
+    }
     virtual QString description() const = 0; /**< @return the Job's description */
     virtual bool run(Report& parent) = 0; /**< @param parent parent Report to add new child to for this Job @return true if successfully run */
 
@@ -81,6 +87,7 @@ public:
     }
 
     void emitProgress(int i);
+    void skip(Report& parent);
 
 protected:
     bool copyBlocks(Report& report, CopyTarget& target, CopySource& source);
@@ -88,6 +95,7 @@ protected:
 
     Report* jobStarted(Report& parent);
     void jobFinished(Report& report, bool b);
+    void onReportProgress(int percent);
 
     void setStatus(JobStatus s) {
         m_Status = s;
@@ -22,6 +22,7 @@
 #include "core/device.h"
 #include "core/copysourcedevice.h"
 #include "core/copytargetdevice.h"
+#include "core/durationestimator.h"
 
 #include "util/report.h"
 
@@ -84,6 +85,11 @@ bool MoveFileSystemJob::run(Report& parent)
     return rval;
 }
 
+qint64 MoveFileSystemJob::estimatedDuration() const
+{
+    return DurationEstimator::copyDuration(&device(), &device(), partition().fileSystem().length() * device().logicalSize());
+}
+
 QString MoveFileSystemJob::description() const
 {
     return xi18nc("@info:progress", "Move the file system on partition <filename>%1</filename> to sector %2", partition().deviceNode(), newStart());
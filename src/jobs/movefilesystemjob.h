@@ -41,6 +41,7 @@ public:
 public:
     bool run(Report& parent) override;
     qint32 numSteps() const override;
+    qint64 estimatedDuration() const override;
     QString description() const override;
 
 protected:
@@ -19,23 +19,60 @@
 
 #include "core/lvmdevice.h"
 
+#include "fs/lvm2_pv.h"
+
+#include "util/externalcommand.h"
 #include "util/report.h"
 
+#include <QElapsedTimer>
+#include <QHash>
+#include <QRegularExpression>
+#include <QThread>
+
 #include <KLocalizedString>
 
+#include <algorithm>
+
+/** One source PV and the pvmove invocations needed to empty it */
+struct MovePhysicalVolumeJob::PvMove
+{
+    QString source;
+    QStringList destinations;
+    QStringList ranges;          // pvmove source arguments, either the whole PV or PE ranges of it
+    QList<qint64> rangePE;       // number of PE in each of ranges
+    int nextRange = 0;
+    qint64 resumeAt = 0;         // do not start the next range before this time (ms), used for the bandwidth cap
+    ExternalCommand* cmd = nullptr;
+
+    bool finished() const {
+        return cmd == nullptr && nextRange >= ranges.size();
+    }
+};
+
 /** Creates a new MovePhysicalVolumeJob
  * @param d Device representing LVM Volume Group
+ * @param partList PVs to move the used PE away from
+ * @param maxBandwidth I/O bandwidth cap in bytes per second for all moves together, 0 for no cap
 */
-MovePhysicalVolumeJob::MovePhysicalVolumeJob(LvmDevice& d, const QStringList partList) :
+MovePhysicalVolumeJob::MovePhysicalVolumeJob(LvmDevice& d, const QStringList partList, qint64 maxBandwidth) :
     Job(),
     m_Device(d),
-    m_PartList(partList)
+    m_PartList(partList),
+    m_MaxBandwidth(maxBandwidth),
+    m_TotalPE(0),
+    m_MovedPE(0),
+    m_LastProgress(-1)
+{
+}
+
+qint32 MovePhysicalVolumeJob::numSteps() const
 {
+    return 100;
 }
 
 bool MovePhysicalVolumeJob::run(Report& parent)
 {
-    bool rval = false;
+    bool rval = true;
 
     Report* report = jobStarted(parent);
 
@@ -46,11 +83,26 @@ bool MovePhysicalVolumeJob::run(Report& parent)
         }
     }
 
-    for (const auto &partPath : partList()) {
-        rval = LvmDevice::movePV(*report, partPath, destinations);
-        if (rval == false) {
+    QList<PvMove> parallel;
+    QList<PvMove> sequential;
+    planMoves(destinations, parallel, sequential);
+
+    m_TotalPE = 0;
+    m_MovedPE = 0;
+    m_LastProgress = -1;
+    for (const auto &move : parallel + sequential)
+        for (const auto &pe : move.rangePE)
+            m_TotalPE += pe;
+
+    if (!parallel.isEmpty())
+        rval = runMoves(*report, parallel);
+
+    for (auto &move : sequential) {
+        if (rval == false)
             break;
-        }
+
+        QList<PvMove> single = { move };
+        rval = runMoves(*report, single);
     }
 
     jobFinished(*report, rval);
@@ -58,6 +110,194 @@ bool MovePhysicalVolumeJob::run(Report& parent)
     return rval;
 }
 
+/** Split the source PVs into moves that can run in parallel and moves that cannot.
+
+    A source PV can be moved in parallel with the others if a set of destination PVs
+    that is not used by any other parallel move has enough free PE for it. All other
+    source PVs are moved one after another and may use all destinations.
+
+    @param destinations PVs that can receive extents
+    @param parallel returns moves with disjoint destination sets
+    @param sequential returns moves that have to run on their own
+*/
+void MovePhysicalVolumeJob::planMoves(const QStringList& destinations, QList<PvMove>& parallel, QList<PvMove>& sequential) const
+{
+    QHash<QString, qint64> freePE;
+    for (const auto &dest : destinations)
+        freePE[dest] = FS::lvm2_pv::getFreePE(dest);
+
+    QList<QPair<qint64, QString>> sources;
+    for (const auto &partPath : partList()) {
+        qint64 allocatedPE = FS::lvm2_pv::getAllocatedPE(partPath);
+        if (allocatedPE > 0)
+            sources.append(QPair<qint64, QString>(allocatedPE, partPath));
+    }
+    // Place the biggest sources first, they are the hardest to fit
+    std::sort(sources.begin(), sources.end(), [](const QPair<qint64, QString>& a, const QPair<qint64, QString>& b) { return a.first > b.first; });
+
+    QStringList unused = destinations;
+    std::sort(unused.begin(), unused.end(), [&freePE](const QString& a, const QString& b) { return freePE[a] > freePE[b]; });
+
+    const qint64 chunkBytes = maxBandwidth() > 0 ? maxBandwidth() * 10 : 0; // about 10 s of I/O per pvmove when capped
+
+    for (const auto &source : sources) {
+        PvMove move;
+        move.source = source.second;
+
+        if (chunkBytes > 0 && device().peSize() > 0) {
+            const qint64 chunkPE = qMax(chunkBytes / device().peSize(), static_cast<qint64>(1));
+            for (const auto &segment : FS::lvm2_pv::getAllocatedSegments(move.source)) {
+                for (qint64 first = segment.first; first < segment.first + segment.second; first += chunkPE) {
+                    const qint64 last = qMin(first + chunkPE, segment.first + segment.second) - 1;
+                    move.ranges.append(move.source + QStringLiteral(":") + QString::number(first) + QStringLiteral("-") + QString::number(last));
+                    move.rangePE.append(last - first + 1);
+                }
+            }
+        }
+        if (move.ranges.isEmpty()) {
+            move.ranges.append(move.source);
+            move.rangePE.append(source.first);
+        }
+
+        qint64 available = 0;
+        QStringList picked;
+        for (const auto &dest : unused) {
+            if (available >= source.first)
+                break;
+            if (freePE[dest] <= 0)
+                continue;
+            picked.append(dest);
+            available += freePE[dest];
+        }
+
+        if (!destinations.isEmpty() && available >= source.first) {
+            for (const auto &dest : picked)
+                unused.removeAll(dest);
+            move.destinations = picked;
+            parallel.append(move);
+        } else {
+            move.destinations = destinations;
+            sequential.append(move);
+        }
+    }
+}
+
+/** Run moves concurrently and wait until all of them are finished.
+
+    No new pvmove is started once one has failed, but those already running are
+    allowed to finish, since interrupting pvmove leaves the VG in an intermediate state.
+
+    @param report the Report to write output to
+    @param moves the moves to run
+    @return true if all moves succeeded
+*/
+bool MovePhysicalVolumeJob::runMoves(Report& report, QList<PvMove>& moves)
+{
+    const int pollInterval = 100;
+    const qint64 perMoveBandwidth = maxBandwidth() > 0 ? qMax(maxBandwidth() / moves.size(), static_cast<qint64>(1)) : 0;
+
+    QElapsedTimer clock;
+    clock.start();
+
+    bool rval = true;
+    bool active = true;
+    while (active) {
+        active = false;
+        bool waited = false;
+
+        for (auto &move : moves) {
+            if (move.cmd == nullptr) {
+                if (!rval || move.finished())
+                    continue;
+
+                active = true;
+                if (clock.elapsed() < move.resumeAt)
+                    continue;
+
+                QStringList args = { QStringLiteral("pvmove"),
+                                     QStringLiteral("--interval"),
+                                     QStringLiteral("5"),
+                                     move.ranges[move.nextRange] };
+                for (const auto &dest : move.destinations)
+                    args << dest.trimmed();
+
+                move.cmd = new ExternalCommand(report, QStringLiteral("lvm"), args);
+                move.resumeAt = clock.elapsed();
+                if (!move.cmd->start(-1)) {
+                    delete move.cmd;
+                    move.cmd = nullptr;
+                    rval = false;
+                    continue;
+                }
+            }
+
+            active = true;
+            if (move.cmd->state() != QProcess::NotRunning) {
+                waited = true;
+                if (!move.cmd->waitForFinished(pollInterval))
+                    continue;
+            }
+
+            const bool success = move.cmd->exitStatus() == QProcess::NormalExit && move.cmd->exitCode() == 0;
+            delete move.cmd;
+            move.cmd = nullptr;
+
+            if (!success) {
+                rval = false;
+                continue;
+            }
+
+            const qint64 movedPE = move.rangePE[move.nextRange];
+            move.nextRange++;
+            m_MovedPE += movedPE;
+
+            if (perMoveBandwidth > 0)
+                move.resumeAt += movedPE * device().peSize() * 1000 / perMoveBandwidth;
+        }
+
+        updateProgress(moves);
+
+        if (active && !waited)
+            QThread::msleep(pollInterval);
+    }
+
+    return rval;
+}
+
+/** Emit the progress of all moves of this job.
+
+    The percentage of the running pvmove invocations is taken from their periodic output.
+
+    @param moves the moves that are currently running
+*/
+void MovePhysicalVolumeJob::updateProgress(const QList<PvMove>& moves)
+{
+    if (m_TotalPE <= 0)
+        return;
+
+    static const QRegularExpression re(QStringLiteral("Moved:\\s*([0-9.]+)%"));
+
+    qint64 movedPE = m_MovedPE;
+    for (const auto &move : moves) {
+        if (move.cmd == nullptr)
+            continue;
+
+        QRegularExpressionMatch lastMatch;
+        QRegularExpressionMatchIterator it = re.globalMatch(move.cmd->output());
+        while (it.hasNext())
+            lastMatch = it.next();
+
+        if (lastMatch.hasMatch())
+            movedPE += static_cast<qint64>(move.rangePE[move.nextRange] * lastMatch.captured(1).toDouble() / 100.0);
+    }
+
+    const int percent = static_cast<int>(qMin(movedPE * 100 / m_TotalPE, static_cast<qint64>(100)));
+    if (percent != m_LastProgress) {
+        m_LastProgress = percent;
+        emitProgress(percent);
+    }
+}
+
 QString MovePhysicalVolumeJob::description() const
 {
     return xi18nc("@info/plain", "Move used PE in %1 on %2 to other available Physical Volumes", partList().join(QStringLiteral(", ")), device().name());
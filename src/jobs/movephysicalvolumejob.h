@@ -26,15 +26,32 @@ class Report;
 
 class QString;
 
+/** Move used PE away from Physical Volumes.
+
+    Source PVs whose extents fit on a set of destination PVs that no other source
+    needs are moved in parallel, all others one after another. Progress of all
+    pvmove processes is reported as a single percentage.
+
+    @author Chantara Tith <tith.chantara@gmail.com>
+*/
 class MovePhysicalVolumeJob : public Job
 {
+    struct PvMove;
+
 public:
-    MovePhysicalVolumeJob(LvmDevice& dev, const QStringList partlist);
+    MovePhysicalVolumeJob(LvmDevice& dev, const QStringList partlist, qint64 maxBandwidth = 0);
 
 public:
     bool run(Report& parent) override;
+    qint32 numSteps() const override;
     QString description() const override;
 
+    qint64 maxBandwidth() const {
+        return m_MaxBandwidth;    /**< @return I/O bandwidth cap in bytes per second, 0 if unlimited */
+    }
+    void setMaxBandwidth(qint64 bytesPerSecond) {
+        m_MaxBandwidth = bytesPerSecond;    /**< @param bytesPerSecond I/O bandwidth cap for all moves together, 0 for no cap */
+    }
 
 protected:
     LvmDevice& device() {
@@ -47,9 +64,17 @@ protected:
         return m_PartList;
     }
 
+    void planMoves(const QStringList& destinations, QList<PvMove>& parallel, QList<PvMove>& sequential) const;
+    bool runMoves(Report& report, QList<PvMove>& moves);
+    void updateProgress(const QList<PvMove>& moves);
+
 private:
     LvmDevice& m_Device;
     const QStringList m_PartList;
+    qint64 m_MaxBandwidth;
+    qint64 m_TotalPE;
+    qint64 m_MovedPE;
+    int m_LastProgress;
 };
 
 #endif
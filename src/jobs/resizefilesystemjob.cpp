@@ -20,11 +20,13 @@
 
 #include "core/partition.h"
 #include "core/device.h"
+#include "core/durationestimator.h"
 
 #include "backend/corebackend.h"
 #include "backend/corebackendmanager.h"
 #include "backend/corebackenddevice.h"
 #include "backend/corebackendpartitiontable.h"
+#include "backend/partitiontabletransaction.h"
 
 #include "fs/filesystem.h"
 
@@ -32,6 +34,7 @@
 #include "util/capacity.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 
 #include <KLocalizedString>
 
@@ -87,10 +90,16 @@ bool ResizeFileSystemJob::run(Report& parent)
 
         case FileSystem::cmdSupportFileSystem: {
             const qint64 newLengthInByte = Capacity(newLength() * device().logicalSize()).toInt(Capacity::Byte);
+            QElapsedTimer timer;
+            timer.start();
+
             if (partition().isMounted())
                 rval = partition().fileSystem().resizeOnline(*report, partition().deviceNode(), partition().mountPoint(), newLengthInByte);
             else
                 rval = partition().fileSystem().resize(*report, partition().deviceNode(), newLengthInByte);
+
+            if (rval)
+                DurationEstimator::recordTool(DurationEstimator::Resize, partition(), timer.elapsed());
             break;
         }
 
@@ -112,10 +121,10 @@ bool ResizeFileSystemJob::resizeFileSystemBackend(Report& report)
 {
     bool rval = false;
 
-    CoreBackendDevice* backendDevice = CoreBackendManager::self()->backend()->openDevice(device().deviceNode());
+    PartitionTableTransaction::Edit edit(device().deviceNode());
 
-    if (backendDevice) {
-        CoreBackendPartitionTable* backendPartitionTable = backendDevice->openPartitionTable();
+    if (edit.backendDevice()) {
+        CoreBackendPartitionTable* backendPartitionTable = edit.backendPartitionTable();
 
         if (backendPartitionTable) {
             connect(CoreBackendManager::self()->backend(), &CoreBackend::progress, this, &ResizeFileSystemJob::progress);
@@ -124,20 +133,26 @@ bool ResizeFileSystemJob::resizeFileSystemBackend(Report& report)
 
             if (rval) {
                 report.line() << xi18nc("@info:progress", "Successfully resized file system using internal backend functions.");
-                backendPartitionTable->commit();
+                edit.commit();
             }
-
-            delete backendPartitionTable;
         } else
             report.line() << xi18nc("@info:progress", "Could not open partition <filename>%1</filename> while trying to resize the file system.", partition().deviceNode());
-
-        delete backendDevice;
     } else
         report.line() << xi18nc("@info:progress", "Could not read geometry for partition <filename>%1</filename> while trying to resize the file system.", partition().deviceNode());
 
     return rval;
 }
 
+qint64 ResizeFileSystemJob::estimatedDuration() const
+{
+    const FileSystem::CommandSupportType support = (newLength() < partition().fileSystem().length()) ? partition().fileSystem().supportShrink() : partition().fileSystem().supportGrow();
+
+    if (partition().fileSystem().length() == newLength() || support != FileSystem::cmdSupportFileSystem)
+        return Job::estimatedDuration();
+
+    return DurationEstimator::toolDuration(DurationEstimator::Resize, partition());
+}
+
 QString ResizeFileSystemJob::description() const
 {
     if (isMaximizing())
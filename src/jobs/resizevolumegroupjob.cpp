@@ -39,15 +39,10 @@ bool ResizeVolumeGroupJob::run(Report& parent)
 
     Report* report = jobStarted(parent);
 
-    for (const auto &pvpath : partList()) {
-        if (type() == ResizeVolumeGroupJob::Grow) {
-            rval = LvmDevice::insertPV(*report, device(), pvpath);
-        } else if (type() == ResizeVolumeGroupJob::Shrink) {
-            rval = LvmDevice::removePV(*report, device(), pvpath);
-        }
-        if (rval == false) {
-            break;
-        }
+    if (type() == ResizeVolumeGroupJob::Grow) {
+        rval = LvmDevice::insertPVs(*report, device(), partList());
+    } else if (type() == ResizeVolumeGroupJob::Shrink) {
+        rval = LvmDevice::removePVs(*report, device(), partList());
     }
 
     jobFinished(*report, rval);
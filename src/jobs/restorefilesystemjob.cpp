@@ -22,17 +22,21 @@
 #include "backend/corebackendmanager.h"
 #include "backend/corebackenddevice.h"
 #include "backend/corebackendpartitiontable.h"
+#include "backend/partitiontabletransaction.h"
 
 #include "core/partition.h"
 #include "core/device.h"
 #include "core/copysourcefile.h"
 #include "core/copytargetdevice.h"
+#include "core/durationestimator.h"
 
 #include "fs/filesystem.h"
 #include "fs/filesystemfactory.h"
 
 #include "util/report.h"
 
+#include <QFileInfo>
+
 #include <KLocalizedString>
 
 /** Creates a new RestoreFileSystemJob
@@ -80,16 +84,12 @@ bool RestoreFileSystemJob::run(Report& parent)
                 // create a new file system for what was restored with the length of the image file
                 const qint64 newLastSector = targetPartition().firstSector() + copySource.length() - 1;
 
-                CoreBackendDevice* backendDevice = CoreBackendManager::self()->backend()->openDevice(targetDevice().deviceNode());
+                PartitionTableTransaction::Edit edit(targetDevice().deviceNode());
 
                 FileSystem::Type t = FileSystem::Unknown;
 
-                if (backendDevice) {
-                    CoreBackendPartitionTable* backendPartitionTable = backendDevice->openPartitionTable();
-
-                    if (backendPartitionTable)
-                        t = backendPartitionTable->detectFileSystemBySector(*report, targetDevice(), targetPartition().firstSector());
-                }
+                if (edit.backendPartitionTable())
+                    t = edit.backendPartitionTable()->detectFileSystemBySector(*report, targetDevice(), targetPartition().firstSector());
 
                 FileSystem* fs = FileSystemFactory::create(t, targetPartition().firstSector(), newLastSector);
 
@@ -106,6 +106,11 @@ bool RestoreFileSystemJob::run(Report& parent)
     return rval;
 }
 
+qint64 RestoreFileSystemJob::estimatedDuration() const
+{
+    return DurationEstimator::copyDuration(nullptr, &targetDevice(), QFileInfo(fileName()).size());
+}
+
 QString RestoreFileSystemJob::description() const
 {
     return xi18nc("@info:progress", "Restore the file system from file <filename>%1</filename> to partition <filename>%2</filename>", fileName(), targetPartition().deviceNode());
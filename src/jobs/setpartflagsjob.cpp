@@ -23,6 +23,7 @@
 #include "backend/corebackenddevice.h"
 #include "backend/corebackendpartition.h"
 #include "backend/corebackendpartitiontable.h"
+#include "backend/partitiontabletransaction.h"
 
 #include "core/device.h"
 #include "core/partition.h"
@@ -57,10 +58,10 @@ bool SetPartFlagsJob::run(Report& parent)
 
     Report* report = jobStarted(parent);
 
-    CoreBackendDevice* backendDevice = CoreBackendManager::self()->backend()->openDevice(device().deviceNode());
+    PartitionTableTransaction::Edit edit(device().deviceNode());
 
-    if (backendDevice) {
-        CoreBackendPartitionTable* backendPartitionTable = backendDevice->openPartitionTable();
+    if (edit.backendDevice()) {
+        CoreBackendPartitionTable* backendPartitionTable = edit.backendPartitionTable();
 
         if (backendPartitionTable) {
             CoreBackendPartition* backendPartition = (partition().roles().has(PartitionRole::Extended))
@@ -87,13 +88,9 @@ bool SetPartFlagsJob::run(Report& parent)
                 report->line() << xi18nc("@info:progress", "Could not find partition <filename>%1</filename> on device <filename>%2</filename> to set partition flags.", partition().deviceNode(), device().deviceNode());
 
             if (rval)
-                backendPartitionTable->commit();
-
-            delete backendPartitionTable;
+                edit.commit();
         } else
             report->line() << xi18nc("@info:progress", "Could not open partition table on device <filename>%1</filename> to set partition flags for partition <filename>%2</filename>.", device().deviceNode(), partition().deviceNode());
-
-        delete backendDevice;
     } else
         report->line() << xi18nc("@info:progress", "Could not open device <filename>%1</filename> to set partition flags for partition <filename>%2</filename>.", device().deviceNode(), partition().deviceNode());
 
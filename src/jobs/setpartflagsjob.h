@@ -42,6 +42,9 @@ public:
 
 public:
     bool run(Report& parent) override;
+    bool needsDeviceNodes() const override {
+        return false;    /**< @return false, only the partition table is edited */
+    }
     qint32 numSteps() const override;
     QString description() const override;
 
@@ -22,6 +22,7 @@
 #include "backend/corebackendmanager.h"
 #include "backend/corebackenddevice.h"
 #include "backend/corebackendpartitiontable.h"
+#include "backend/partitiontabletransaction.h"
 
 #include "core/partition.h"
 #include "core/device.h"
@@ -56,10 +57,10 @@ bool SetPartGeometryJob::run(Report& parent)
     Report* report = jobStarted(parent);
 
     if(device().type() == Device::Disk_Device) {
-        CoreBackendDevice* backendDevice = CoreBackendManager::self()->backend()->openDevice(device().deviceNode());
+        PartitionTableTransaction::Edit edit(device().deviceNode());
 
-        if (backendDevice) {
-            CoreBackendPartitionTable* backendPartitionTable = backendDevice->openPartitionTable();
+        if (edit.backendDevice()) {
+            CoreBackendPartitionTable* backendPartitionTable = edit.backendPartitionTable();
 
             if (backendPartitionTable) {
                 rval = backendPartitionTable->updateGeometry(*report, partition(), newStart(), newStart() + newLength() - 1);
@@ -67,14 +68,9 @@ bool SetPartGeometryJob::run(Report& parent)
                 if (rval) {
                     partition().setFirstSector(newStart());
                     partition().setLastSector(newStart() + newLength() - 1);
-                    backendPartitionTable->commit();
+                    edit.commit();
                 }
-
-                delete backendPartitionTable;
             }
-
-
-            delete backendDevice;
         } else
             report->line() << xi18nc("@info:progress", "Could not open device <filename>%1</filename> while trying to resize/move partition <filename>%2</filename>.", device().deviceNode(), partition().deviceNode());
     } else if (device().type() == Device::LVM_Device) {
@@ -82,7 +78,7 @@ bool SetPartGeometryJob::run(Report& parent)
         partition().setFirstSector(newStart());
         partition().setLastSector(newStart() + newLength() - 1);
 
-        rval = LvmDevice::resizeLV(*report, partition());
+        rval = LvmDevice::resizeLV(*report, dynamic_cast<LvmDevice&>(device()), partition());
     }
 
     jobFinished(*report, rval);
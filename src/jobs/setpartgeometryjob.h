@@ -44,6 +44,9 @@ public:
 
 public:
     bool run(Report& parent) override;
+    bool needsDeviceNodes() const override {
+        return false;    /**< @return false, only the partition table is edited */
+    }
     QString description() const override;
 
 protected:
@@ -22,6 +22,7 @@
 #include "core/device.h"
 #include "core/copysourceshred.h"
 #include "core/copytargetdevice.h"
+#include "core/durationestimator.h"
 
 #include "fs/filesystem.h"
 #include "fs/filesystemfactory.h"
@@ -82,6 +83,11 @@ bool ShredFileSystemJob::run(Report& parent)
     return rval;
 }
 
+qint64 ShredFileSystemJob::estimatedDuration() const
+{
+    return DurationEstimator::copyDuration(nullptr, &device(), partition().length() * device().logicalSize());
+}
+
 QString ShredFileSystemJob::description() const
 {
     return xi18nc("@info:progress", "Shred the file system on <filename>%1</filename>", partition().deviceNode());
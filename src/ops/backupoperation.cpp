@@ -49,6 +49,11 @@ QString BackupOperation::description() const
     return xi18nc("@info:status", "Backup partition <filename>%1</filename> (%2, %3) to <filename>%4</filename>", backupPartition().deviceNode(), Capacity::formatByteSize(backupPartition().capacity()), backupPartition().fileSystem().name(), fileName());
 }
 
+bool BackupOperation::readsFrom(const Device& d) const
+{
+    return d == targetDevice();
+}
+
 /** Can the given Partition be backed up?
     @param p The Partition in question, may be nullptr.
     @return true if @p p can be backed up.
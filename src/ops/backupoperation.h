@@ -54,6 +54,7 @@ public:
     bool targets(const Partition&) const override{
         return false;
     }
+    bool readsFrom(const Device& d) const override;
 
     static bool canBackup(const Partition* p);
 
@@ -33,6 +33,7 @@
 #include "util/report.h"
 
 #include <QDebug>
+#include <QFileInfo>
 #include <QString>
 
 #include <KLocalizedString>
@@ -51,6 +52,7 @@ CopyOperation::CopyOperation(Device& targetdevice, Partition* copiedpartition, D
     m_SourcePartition(sourcepartition),
     m_OverwrittenPartition(nullptr),
     m_MustDeleteOverwritten(false),
+    m_AllowSnapshotClone(true),
     m_CheckSourceJob(nullptr),
     m_CreatePartitionJob(nullptr),
     m_CopyFSJob(nullptr),
@@ -101,6 +103,11 @@ bool CopyOperation::targets(const Partition& p) const
     return p == copiedPartition();
 }
 
+bool CopyOperation::readsFrom(const Device& d) const
+{
+    return d == sourceDevice();
+}
+
 void CopyOperation::preview()
 {
     if (overwrittenPartition())
@@ -131,9 +138,17 @@ bool CopyOperation::execute(Report& parent)
         // to adjust that before we're creating it.
         copiedPartition().setDevicePath(targetDevice().deviceNode());
 
-        // either we have no partition to create (because we're overwriting) or creating
+        // a new thin LV in the same VG is created by the copy job itself as a thin snapshot
+        const bool snapshotClone = allowSnapshotClone() && createPartitionJob() && copyFSJob()->canCloneBySnapshot();
+        copyFSJob()->setCloneBySnapshot(snapshotClone);
+
+        // the copy job creates the snapshot LV itself
+        if (snapshotClone)
+            createPartitionJob()->skip(*report);
+
+        // either we have no partition to create (because we're overwriting or cloning) or creating
         // must be successful
-        if (!createPartitionJob() || (rval = createPartitionJob()->run(*report))) {
+        if (!createPartitionJob() || snapshotClone || (rval = createPartitionJob()->run(*report))) {
             // set the state of the target partition from StateCopy to StateNone or checking
             // it will fail (because its deviceNode() will still be "Copy of sdXn"). This is
             // only required for overwritten partitions, but doesn't hurt in any case.
@@ -160,7 +175,8 @@ bool CopyOperation::execute(Report& parent)
                 } else
                     report->line() << xi18nc("@info:status", "Checking target partition <filename>%1</filename> after copy failed.", copiedPartition().deviceNode());
             } else {
-                if (createPartitionJob()) {
+                // a failed snapshot clone removes its LV itself, unless it failed afterwards
+                if (createPartitionJob() && (!snapshotClone || QFileInfo::exists(copiedPartition().partitionPath()))) {
                     DeletePartitionJob deleteJob(targetDevice(), copiedPartition());
                     deleteJob.run(*report);
                 }
@@ -67,12 +67,20 @@ public:
 
     bool targets(const Device& d) const override;
     bool targets(const Partition& p) const override;
+    bool readsFrom(const Device& d) const override;
 
     static bool canCopy(const Partition* p);
     static bool canPaste(const Partition* p, const Partition* source);
 
     static Partition* createCopy(const Partition& target, const Partition& source);
 
+    bool allowSnapshotClone() const {
+        return m_AllowSnapshotClone;    /**< @return true if a thin LV may be copied as a thin snapshot */
+    }
+    void setAllowSnapshotClone(bool b) {
+        m_AllowSnapshotClone = b;    /**< @param b false to always copy all data, e.g. to get a copy that shares no blocks with the source */
+    }
+
 protected:
     Partition& copiedPartition() {
         return *m_CopiedPartition;
@@ -144,6 +152,7 @@ private:
     Partition* m_SourcePartition;
     Partition* m_OverwrittenPartition;
     bool m_MustDeleteOverwritten;
+    bool m_AllowSnapshotClone;
 
     CheckFileSystemJob* m_CheckSourceJob;
     CreatePartitionJob* m_CreatePartitionJob;
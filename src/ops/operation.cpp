@@ -18,6 +18,8 @@
 
 #include "ops/operation.h"
 
+#include "backend/partitiontabletransaction.h"
+
 #include "core/partition.h"
 #include "core/device.h"
 
@@ -49,11 +51,9 @@ void Operation::insertPreviewPartition(Device& device, Partition& p)
 {
     Q_ASSERT(device.partitionTable());
 
-    device.partitionTable()->removeUnallocated();
-
     p.parent()->insert(&p);
 
-    device.partitionTable()->updateUnallocated(device);
+    device.partitionTable()->updateUnallocated(device, p);
 }
 
 void Operation::removePreviewPartition(Device& device, Partition& p)
@@ -61,7 +61,7 @@ void Operation::removePreviewPartition(Device& device, Partition& p)
     Q_ASSERT(device.partitionTable());
 
     if (p.parent()->remove(&p))
-        device.partitionTable()->updateUnallocated(device);
+        device.partitionTable()->updateUnallocated(device, p);
     else
         qWarning() << "failed to remove partition " << p.deviceNode() << " at " << &p << " from preview.";
 }
@@ -163,9 +163,17 @@ bool Operation::execute(Report& parent)
     Report* report = parent.newChild(description());
 
     const auto Jobs = jobs();
-    for (const auto &job : Jobs)
+    for (const auto &job : Jobs) {
+        // let the kernel catch up with batched partition table edits before using device nodes;
+        // if that fails, the following Jobs would work on a table that was never written
+        if (job->needsDeviceNodes() && PartitionTableTransaction::current() && !PartitionTableTransaction::current()->commit(report)) {
+            rval = false;
+            break;
+        }
+
         if (!(rval = job->run(*report)))
             break;
+    }
 
     setStatus(rval ? StatusFinishedSuccess : StatusError);
 
@@ -77,6 +77,7 @@ class LIBKPMCORE_EXPORT Operation : public QObject
 
     friend class OperationStack;
     friend class OperationRunner;
+    friend class DurationEstimator;
 
 public:
     /** Status of this Operation */
@@ -107,6 +108,9 @@ public:
 
     virtual bool targets(const Device&) const = 0;
     virtual bool targets(const Partition&) const = 0;
+    virtual bool readsFrom(const Device&) const {
+        return false;    /**< @return true if the Operation reads from the Device without changing it */
+    }
 
     virtual OperationStatus status() const {
         return m_Status;    /**< @return the current status */
@@ -23,6 +23,30 @@
 #include "util/globallog.h"
 #include "util/report.h"
 
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+
+#include <cstring>
+
+namespace
+{
+
+/** the sector size of the devices DummyBackend::scanDevice() creates */
+const qint64 dummySectorSize = 512;
+
+/** What has been written to dummy devices, by device node and sector, so that it can be read
+    back. Sectors that only hold zeros are not kept.
+*/
+struct SectorStore {
+    QMutex mutex;
+    QHash<QString, QHash<qint64, QByteArray>> sectors;
+};
+
+Q_GLOBAL_STATIC(SectorStore, sectorStore)
+
+}
+
 DummyDevice::DummyDevice(const QString& device_node) :
     CoreBackendDevice(device_node)
 {
@@ -39,11 +63,13 @@ bool DummyDevice::open()
 
 bool DummyDevice::openExclusive()
 {
+    setExclusive(true);
     return true;
 }
 
 bool DummyDevice::close()
 {
+    setExclusive(false);
     return true;
 }
 
@@ -69,24 +95,47 @@ bool DummyDevice::createPartitionTable(Report& report, const PartitionTable& pta
 
 bool DummyDevice::readSectors(void* buffer, qint64 offset, qint64 numSectors)
 {
-    Q_UNUSED(buffer);
-    Q_UNUSED(offset);
-    Q_UNUSED(numSectors);
-
     if (!isExclusive())
         return false;
 
+    QMutexLocker locker(&sectorStore->mutex);
+    const QHash<qint64, QByteArray>& sectors = sectorStore->sectors[deviceNode()];
+
+    char* p = static_cast<char*>(buffer);
+    for (qint64 i = 0; i < numSectors; i++, p += dummySectorSize) {
+        const auto it = sectors.constFind(offset + i);
+
+        if (it == sectors.constEnd())
+            memset(p, 0, dummySectorSize);
+        else
+            memcpy(p, it->constData(), dummySectorSize);
+    }
+
     return true;
 }
 
 bool DummyDevice::writeSectors(void* buffer, qint64 offset, qint64 numSectors)
 {
-    Q_UNUSED(buffer);
-    Q_UNUSED(offset);
-    Q_UNUSED(numSectors);
-
     if (!isExclusive())
         return false;
 
+    QMutexLocker locker(&sectorStore->mutex);
+    QHash<qint64, QByteArray>& sectors = sectorStore->sectors[deviceNode()];
+
+    const char* p = static_cast<const char*>(buffer);
+    for (qint64 i = 0; i < numSectors; i++, p += dummySectorSize) {
+        const QByteArray data(p, dummySectorSize);
+
+        if (data.count('\0') == dummySectorSize)
+            sectors.remove(offset + i);
+        else
+            sectors.insert(offset + i, data);
+    }
+
     return true;
 }
+
+bool DummyDevice::sync()
+{
+    return isExclusive();
+}
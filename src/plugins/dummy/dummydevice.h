@@ -47,6 +47,7 @@ public:
 
     bool readSectors(void* buffer, qint64 offset, qint64 numSectors) override;
     bool writeSectors(void* buffer, qint64 offset, qint64 numSectors) override;
+    bool sync() override;
 };
 
 #endif
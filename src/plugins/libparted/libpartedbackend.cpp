@@ -50,7 +50,6 @@
 
 #include <KAuth>
 #include <KLocalizedString>
-#include <KDiskFreeSpaceInfo>
 #include <KPluginFactory>
 
 #include <unistd.h>
@@ -94,24 +93,6 @@ static qint64 readSectorsUsedLibParted(const Partition& p)
 }
 #endif
 
-/** Reads the sectors used in a FileSystem and stores the result in the Partition's FileSystem object.
-    @param p the Partition the FileSystem is on
-    @param mountPoint mount point of the partition in question
-*/
-static void readSectorsUsed(const DiskDevice& d, Partition& p, const QString& mountPoint)
-{
-    const KDiskFreeSpaceInfo freeSpaceInfo = KDiskFreeSpaceInfo::freeSpaceInfo(mountPoint);
-
-    if (p.isMounted() && freeSpaceInfo.isValid() && mountPoint != QString())
-        p.fileSystem().setSectorsUsed(freeSpaceInfo.used() / d.logicalSectorSize());
-    else if (p.fileSystem().supportGetUsed() == FileSystem::cmdSupportFileSystem)
-        p.fileSystem().setSectorsUsed(p.fileSystem().readUsedCapacity(p.deviceNode()) / d.logicalSectorSize());
-#if defined LIBPARTED_FS_RESIZE_LIBRARY_SUPPORT
-    else if (p.fileSystem().supportGetUsed() == FileSystem::cmdSupportBackend)
-        p.fileSystem().setSectorsUsed(readSectorsUsedLibParted(p));
-#endif
-}
-
 /** Constructs a LibParted object. */
 LibPartedBackend::LibPartedBackend(QObject*, const QList<QVariant>&) :
     CoreBackend()
@@ -255,8 +236,12 @@ Device* LibPartedBackend::scanDevice(const QString& deviceNode)
         PartitionTable::Flags active = static_cast<PartitionTable::Flag>(activeFlags[i].toInt());
         Partition* part = new Partition(parent, *d, PartitionRole(r), fs, start, end, partitionNode, available, mountPoint, mounted, active);
 
-        if (!part->roles().has(PartitionRole::Luks))
-            readSectorsUsed(*d, *part, mountPoint);
+        if (!part->roles().has(PartitionRole::Luks) && !CoreBackend::readSectorsUsed(*d, *part, mountPoint)) {
+#if defined LIBPARTED_FS_RESIZE_LIBRARY_SUPPORT
+            if (fs->supportGetUsed() == FileSystem::cmdSupportBackend)
+                fs->setSectorsUsed(readSectorsUsedLibParted(*part));
+#endif
+        }
 
         if (fs->supportGetLabel() != FileSystem::cmdSupportNone)
             fs->setLabel(fs->readLabel(part->deviceNode()));
@@ -281,40 +266,7 @@ Device* LibPartedBackend::scanDevice(const QString& deviceNode)
 
 QList<Device*> LibPartedBackend::scanDevices(bool excludeReadOnly)
 {
-    QList<Device*> result;
-    // linux.git/tree/Documentation/devices.txt
-    QString blockDeviceMajorNumbers = QStringLiteral(
-        "3,22,33,34,56,57,88,89,90,91,128,129,130,131,132,133,134,135," // MFM, RLL and IDE hard disk/CD-ROM interface
-        "7," // loop devices
-        "8,65,66,67,68,69,70,71," // SCSI disk devices
-        "80,81,82,83,84,85,86,87," // I2O hard disk
-        "179," // MMC block devices
-        "259" // Block Extended Major (include NVMe)
-    );
-    ExternalCommand cmd(QStringLiteral("lsblk"), {
-                          QStringLiteral("--nodeps"),
-                          QStringLiteral("--noheadings"),
-                          QStringLiteral("--output"), QString::fromLatin1("name"),
-                          QStringLiteral("--paths"),
-                          QStringLiteral("--include"), blockDeviceMajorNumbers});
-    if (cmd.run(-1) && cmd.exitCode() == 0) {
-        QStringList devices = cmd.output().split(QString::fromLatin1("\n"));
-        devices.removeLast();
-        quint32 totalDevices = devices.length();
-        for (quint32 i = 0; i < totalDevices; ++i) {
-            if (excludeReadOnly) {
-                QFile f(QStringLiteral("/sys/block/%1/ro").arg(QString(devices[i]).remove(QStringLiteral("/dev/"))));
-                if (f.open(QIODevice::ReadOnly))
-                    if (f.readLine().trimmed().toInt() == 1)
-                        continue;
-            }
-
-            emitScanProgress(devices[i], i * 100 / totalDevices);
-            result.append(scanDevice(devices[i]));
-        }
-    }
-
-    return result;
+    return scanBlockDevices(excludeReadOnly);
 }
 
 /** Detects the type of a FileSystem given a PedDevice and a PedPartition
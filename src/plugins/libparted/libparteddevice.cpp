@@ -128,3 +128,12 @@ bool LibPartedDevice::writeSectors(void* buffer, qint64 offset, qint64 numSector
 
     return ped_device_write(pedDevice(), buffer, offset, numSectors);
 }
+
+bool LibPartedDevice::sync()
+{
+    if (!isExclusive())
+        return false;
+
+    // unlike closing, this keeps the device open, but also flushes the caches of the partitions
+    return ped_device_sync(pedDevice());
+}
@@ -28,8 +28,9 @@
 
 #include "fs/filesystem.h"
 
+#include "util/globallog.h"
 #include "util/report.h"
-#include "util/externalcommand.h"
+#include "util/ueventmonitor.h"
 
 #include <KLocalizedString>
 
@@ -64,14 +65,22 @@ bool LibPartedPartitionTable::commit(PedDisk* pd, quint32 timeout)
     if (pd == nullptr)
         return false;
 
+    QMap<qint32, qint64> starts;
+    for (PedPartition* p = ped_disk_next_partition(pd, nullptr); p != nullptr; p = ped_disk_next_partition(pd, p))
+        if (p->num > 0)
+            starts[p->num] = p->geom.start * pd->dev->sector_size;
+
+    // subscribe before committing so that no event gets lost
+    UeventMonitor monitor;
+    monitor.expectPartitions(QString::fromLocal8Bit(pd->dev->path), starts);
+
     bool rval = ped_disk_commit_to_dev(pd);
 
     if (rval)
         rval = ped_disk_commit_to_os(pd);
 
-    if (!ExternalCommand(QStringLiteral("udevadm"), QStringList() << QStringLiteral("settle") << QStringLiteral("--timeout=") + QString::number(timeout)).run() &&
-            !ExternalCommand(QStringLiteral("udevsettle"), QStringList() << QStringLiteral("--timeout=") + QString::number(timeout)).run())
-        sleep(timeout);
+    if (!monitor.wait(timeout))
+        Log(Log::warning) << xi18nc("@info:status", "Timed out waiting for device nodes: <filename>%1</filename>", monitor.lateNodes().join(QStringLiteral(", ")));
 
     return rval;
 }
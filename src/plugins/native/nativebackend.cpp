@@ -0,0 +1,280 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+/** @file
+*/
+
+#include "plugins/native/nativebackend.h"
+#include "plugins/native/nativedevice.h"
+#include "plugins/native/nativedisklabel.h"
+#include "plugins/native/nativepartitiontable.h"
+
+#include "core/diskdevice.h"
+#include "core/partition.h"
+#include "core/partitiontable.h"
+#include "core/partitionalignment.h"
+
+#include "fs/filesystem.h"
+#include "fs/filesystemfactory.h"
+#include "fs/luks.h"
+
+#include "util/globallog.h"
+#include "util/externalcommand.h"
+
+#include <blkid/blkid.h>
+
+#include <QDebug>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+#include <KLocalizedString>
+#include <KPluginFactory>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+K_PLUGIN_FACTORY_WITH_JSON(NativeBackendFactory, "pmnativebackendplugin.json", registerPlugin<NativeBackend>();)
+
+static const struct {
+    const char* name;
+    FileSystem::Type type;
+} mapBlkidNameToFileSystemType[] = {
+    { "ext2", FileSystem::Ext2 },
+    { "ext3", FileSystem::Ext3 },
+    { "ext4", FileSystem::Ext4 },
+    { "ext4dev", FileSystem::Ext4 },
+    { "swap", FileSystem::LinuxSwap },
+    { "ntfs", FileSystem::Ntfs },
+    { "reiserfs", FileSystem::ReiserFS },
+    { "reiser4", FileSystem::Reiser4 },
+    { "xfs", FileSystem::Xfs },
+    { "jfs", FileSystem::Jfs },
+    { "hfs", FileSystem::Hfs },
+    { "hfsplus", FileSystem::HfsPlus },
+    { "ufs", FileSystem::Ufs },
+    { "btrfs", FileSystem::Btrfs },
+    { "ocfs2", FileSystem::Ocfs2 },
+    { "zfs_member", FileSystem::Zfs },
+    { "hpfs", FileSystem::Hpfs },
+    { "crypto_LUKS", FileSystem::Luks },
+    { "exfat", FileSystem::Exfat },
+    { "nilfs2", FileSystem::Nilfs2 },
+    { "LVM2_member", FileSystem::Lvm2_PV },
+    { "f2fs", FileSystem::F2fs }
+};
+
+/** @return vendor and model of a disk as reported by sysfs */
+static QString readModel(const QString& deviceNode)
+{
+    const QString sysfs = QStringLiteral("/sys/block/%1/device/").arg(QString(deviceNode).remove(QStringLiteral("/dev/")));
+    QStringList model;
+
+    for (const auto &attribute : { QStringLiteral("vendor"), QStringLiteral("model") }) {
+        QFile f(sysfs + attribute);
+        if (f.open(QIODevice::ReadOnly)) {
+            const QString s = QString::fromLocal8Bit(f.readLine()).trimmed();
+            if (!s.isEmpty())
+                model.append(s);
+        }
+    }
+
+    return model.isEmpty() ? QStringLiteral("Unknown") : model.join(QStringLiteral(" "));
+}
+
+NativeBackend::NativeBackend(QObject*, const QList<QVariant>&) :
+    CoreBackend()
+{
+}
+
+void NativeBackend::initFSSupport()
+{
+}
+
+/** Create a Device for the given deviceNode and scan it for partitions.
+    @param deviceNode the device node (e.g. "/dev/sda")
+    @return the created Device object. callers need to free this.
+*/
+Device* NativeBackend::scanDevice(const QString& deviceNode)
+{
+    NativeDiskLabel label;
+    const int fd = ::open(deviceNode.toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1 || !label.read(fd)) {
+        if (fd != -1)
+            ::close(fd);
+        Log(Log::warning) << xi18nc("@info:status", "Could not access device <filename>%1</filename>", deviceNode);
+        return nullptr;
+    }
+
+    ::close(fd);
+
+    const QString model = readModel(deviceNode);
+
+    Log(Log::information) << xi18nc("@info:status", "Device found: %1", model);
+
+    // the same made up BIOS geometry libparted reports
+    qint32 heads = 255;
+    qint32 sectors = 63;
+    qint64 cylinders = label.totalSectors() / (heads * sectors);
+
+    if (cylinders == 0) {
+        heads = 1;
+        sectors = 1;
+        cylinders = label.totalSectors();
+    }
+
+    DiskDevice* d = new DiskDevice(model, deviceNode, heads, sectors, static_cast<qint32>(cylinders), label.sectorSize());
+
+    if (label.type() == PartitionTable::unknownTableType)
+        return d;
+
+    const qint64 firstUsable = label.type() == PartitionTable::gpt ? label.firstUsable() : sectors;
+    const qint64 lastUsable = label.type() == PartitionTable::gpt ? label.lastUsable() : d->totalSectors() - 1;
+
+    CoreBackend::setPartitionTableForDevice(*d, new PartitionTable(label.type(), firstUsable, lastUsable));
+    CoreBackend::setPartitionTableMaxPrimaries(*d->partitionTable(), label.maxPrimaries());
+
+    // entries are sorted with the extended partition ahead of its logicals
+    QList<Partition*> partitions;
+    for (const auto &e : label.entries()) {
+        const QString partitionNode = NativePartitionTable::partitionNode(deviceNode, e.number);
+        PartitionRole::Roles r = e.role;
+        FileSystem::Type fsType = r.testFlag(PartitionRole::Extended) ? FileSystem::Extended : detectFileSystem(partitionNode);
+
+        // Find an extended partition this partition is in.
+        PartitionNode* parent = d->partitionTable()->findPartitionBySector(e.firstSector, PartitionRole(PartitionRole::Extended));
+
+        // None found, so it's a primary in the device's partition table.
+        if (parent == nullptr)
+            parent = d->partitionTable();
+
+        FileSystem* fs = FileSystemFactory::create(fsType, e.firstSector, e.lastSector);
+        fs->scan(partitionNode);
+        QString mountPoint;
+        bool mounted;
+
+        if (fs->type() == FileSystem::Luks) {
+            r |= PartitionRole::Luks;
+            FS::luks::initLUKS(fs);
+            QString mapperNode = static_cast<FS::luks*>(fs)->mapperName();
+            mountPoint = FileSystem::detectMountPoint(fs, mapperNode);
+            mounted    = FileSystem::detectMountStatus(fs, mapperNode);
+        } else {
+            mountPoint = FileSystem::detectMountPoint(fs, partitionNode);
+            mounted = FileSystem::detectMountStatus(fs, partitionNode);
+        }
+
+        Partition* part = new Partition(parent, *d, PartitionRole(r), fs, e.firstSector, e.lastSector, partitionNode, label.availableFlags(e), mountPoint, mounted, label.activeFlags(e));
+
+        if (!part->roles().has(PartitionRole::Luks))
+            CoreBackend::readSectorsUsed(*d, *part, mountPoint);
+
+        if (fs->supportGetLabel() != FileSystem::cmdSupportNone)
+            fs->setLabel(fs->readLabel(part->deviceNode()));
+
+        if (fs->supportGetUUID() != FileSystem::cmdSupportNone)
+            fs->setUUID(fs->readUUID(part->deviceNode()));
+
+        parent->append(part);
+        partitions.append(part);
+    }
+
+    d->partitionTable()->updateUnallocated(*d);
+
+    if (d->partitionTable()->isSectorBased(*d))
+        d->partitionTable()->setType(*d, PartitionTable::msdos_sectorbased);
+
+    for (const auto &part : partitions)
+        PartitionAlignment::isAligned(*d, *part);
+
+    return d;
+}
+
+QList<Device*> NativeBackend::scanDevices(bool excludeReadOnly)
+{
+    return scanBlockDevices(excludeReadOnly);
+}
+
+/** Detects the type of a FileSystem on a partition using libblkid
+    @param partitionPath path to the partition
+    @return the detected FileSystem type (FileSystem::Unknown if not detected)
+*/
+FileSystem::Type NativeBackend::detectFileSystem(const QString& partitionPath)
+{
+    FileSystem::Type rval = FileSystem::Unknown;
+
+    blkid_cache cache;
+    if (blkid_get_cache(&cache, nullptr) == 0) {
+        const QByteArray path = partitionPath.toLocal8Bit();
+
+        if (blkid_get_dev(cache, path.constData(), BLKID_DEV_NORMAL) != nullptr) {
+            char* string = blkid_get_tag_value(cache, "TYPE", path.constData());
+            const QString s = QString::fromUtf8(string);
+            free(string);
+
+            if (s == QStringLiteral("vfat")) {
+                // libblkid uses SEC_TYPE to distinguish between FAT16 and FAT32
+                string = blkid_get_tag_value(cache, "SEC_TYPE", path.constData());
+                rval = QString::fromUtf8(string) == QStringLiteral("msdos") ? FileSystem::Fat16 : FileSystem::Fat32;
+                free(string);
+            } else {
+                for (const auto &m : mapBlkidNameToFileSystemType)
+                    if (s == QLatin1String(m.name))
+                        rval = m.type;
+
+                if (rval == FileSystem::Unknown && !s.isEmpty())
+                    qWarning() << "blkid: unknown file system type " << s << " on " << partitionPath;
+            }
+        }
+
+        blkid_put_cache(cache);
+    }
+
+    return rval;
+}
+
+CoreBackendDevice* NativeBackend::openDevice(const QString& deviceNode)
+{
+    NativeDevice* device = new NativeDevice(deviceNode);
+
+    if (device == nullptr || !device->open()) {
+        delete device;
+        device = nullptr;
+    }
+
+    return device;
+}
+
+CoreBackendDevice* NativeBackend::openDeviceExclusive(const QString& deviceNode)
+{
+    NativeDevice* device = new NativeDevice(deviceNode);
+
+    if (device == nullptr || !device->openExclusive()) {
+        delete device;
+        device = nullptr;
+    }
+
+    return device;
+}
+
+bool NativeBackend::closeDevice(CoreBackendDevice* core_device)
+{
+    return core_device->close();
+}
+
+#include "nativebackend.moc"
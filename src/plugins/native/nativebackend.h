@@ -0,0 +1,58 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#if !defined(NATIVEBACKEND__H)
+
+#define NATIVEBACKEND__H
+
+#include "backend/corebackend.h"
+
+#include <QList>
+#include <QVariant>
+
+class Device;
+class KPluginFactory;
+class QString;
+
+/** Backend plugin that reads and writes MBR and GPT partition tables itself.
+
+    Unlike the libparted backend this one does not need libparted or its KAuth scan
+    helper. Devices are read directly, so scanning requires read access to them.
+
+    @author Andrius Štikonas <andrius@stikonas.eu>
+*/
+class NativeBackend : public CoreBackend
+{
+    friend class KPluginFactory;
+
+    Q_DISABLE_COPY(NativeBackend)
+
+private:
+    NativeBackend(QObject* parent, const QList<QVariant>& args);
+
+public:
+    void initFSSupport() override;
+
+    QList<Device*> scanDevices(bool excludeReadOnly = false) override;
+    CoreBackendDevice* openDevice(const QString& deviceNode) override;
+    CoreBackendDevice* openDeviceExclusive(const QString& deviceNode) override;
+    bool closeDevice(CoreBackendDevice* core_device) override;
+    Device* scanDevice(const QString& deviceNode) override;
+    FileSystem::Type detectFileSystem(const QString& partitionPath) override;
+};
+
+#endif
@@ -0,0 +1,249 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#include "plugins/native/nativedevice.h"
+#include "plugins/native/nativedisklabel.h"
+#include "plugins/native/nativepartitiontable.h"
+
+#include "core/partitiontable.h"
+
+#include "util/report.h"
+
+#include <KLocalizedString>
+
+#include <cerrno>
+#include <climits>
+
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace
+{
+
+/** Reads or writes all of the given buffers at a position, continuing after short transfers. */
+bool transferAll(int fd, struct iovec* iov, int count, qint64 pos, bool write)
+{
+    forever {
+        while (count > 0 && iov->iov_len == 0) {
+            iov++;
+            count--;
+        }
+
+        if (count == 0)
+            return true;
+
+        ssize_t n = write ? pwritev(fd, iov, count, pos) : preadv(fd, iov, count, pos);
+        if (n <= 0)
+            return false;
+
+        pos += n;
+
+        while (n > 0) {
+            if (static_cast<size_t>(n) < iov->iov_len) {
+                iov->iov_base = static_cast<char*>(iov->iov_base) + n;
+                iov->iov_len -= n;
+                break;
+            }
+
+            n -= iov->iov_len;
+            iov++;
+            count--;
+        }
+    }
+}
+
+}
+
+NativeDevice::NativeDevice(const QString& deviceNode) :
+    CoreBackendDevice(deviceNode),
+    m_Fd(-1),
+    m_SectorSize(512)
+{
+}
+
+NativeDevice::~NativeDevice()
+{
+    if (fd() != -1)
+        close();
+}
+
+bool NativeDevice::open(int flags)
+{
+    Q_ASSERT(fd() == -1);
+
+    if (fd() != -1)
+        return false;
+
+    m_Fd = ::open(deviceNode().toLocal8Bit().constData(), flags | O_CLOEXEC);
+
+    qint64 totalSectors;
+    if (fd() == -1 || !NativeDiskLabel::probe(fd(), m_SectorSize, totalSectors)) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+bool NativeDevice::open()
+{
+    return open(O_RDONLY);
+}
+
+bool NativeDevice::openExclusive()
+{
+    bool rval = open(O_RDWR);
+
+    if (rval)
+        setExclusive(true);
+
+    return rval;
+}
+
+bool NativeDevice::close()
+{
+    if (fd() != -1)
+        ::close(fd());
+
+    m_Fd = -1;
+    setExclusive(false);
+
+    return true;
+}
+
+CoreBackendPartitionTable* NativeDevice::openPartitionTable()
+{
+    CoreBackendPartitionTable* ptable = new NativePartitionTable(deviceNode());
+
+    if (ptable == nullptr || !ptable->open()) {
+        delete ptable;
+        ptable = nullptr;
+    }
+
+    return ptable;
+}
+
+bool NativeDevice::createPartitionTable(Report& report, const PartitionTable& ptable)
+{
+    if (ptable.type() != PartitionTable::msdos && ptable.type() != PartitionTable::msdos_sectorbased && ptable.type() != PartitionTable::gpt) {
+        report.line() << xi18nc("@info:progress", "Creating partition table failed: Partition table type \"%1\" is not supported for <filename>%2</filename>.", ptable.typeName(), deviceNode());
+        return false;
+    }
+
+    NativePartitionTable table(deviceNode());
+
+    if (!table.read()) {
+        report.line() << xi18nc("@info:progress", "Creating partition table failed: Could not open backend device <filename>%1</filename>.", deviceNode());
+        return false;
+    }
+
+    table.label().reset(ptable.type());
+
+    return table.commit();
+}
+
+bool NativeDevice::readSectors(void* buffer, qint64 offset, qint64 numSectors)
+{
+    if (!isExclusive())
+        return false;
+
+    char* p = static_cast<char*>(buffer);
+    const qint64 length = numSectors * m_SectorSize;
+
+    for (qint64 done = 0; done < length; ) {
+        const ssize_t n = pread(fd(), p + done, length - done, offset * m_SectorSize + done);
+        if (n <= 0)
+            return false;
+        done += n;
+    }
+
+    return true;
+}
+
+bool NativeDevice::writeSectors(void* buffer, qint64 offset, qint64 numSectors)
+{
+    if (!isExclusive())
+        return false;
+
+    const char* p = static_cast<const char*>(buffer);
+    const qint64 length = numSectors * m_SectorSize;
+
+    for (qint64 done = 0; done < length; ) {
+        const ssize_t n = pwrite(fd(), p + done, length - done, offset * m_SectorSize + done);
+        if (n <= 0)
+            return false;
+        done += n;
+    }
+
+    return true;
+}
+
+bool NativeDevice::sync()
+{
+    if (!isExclusive())
+        return false;
+
+    // BLKFLSBUF writes back and then drops the device's buffers, so data written through
+    // partition device nodes in the meantime is read from disk again; images have no buffers
+    return fdatasync(fd()) == 0 && (ioctl(fd(), BLKFLSBUF) == 0 || errno == ENOTTY);
+}
+
+bool NativeDevice::readSegments(const QVector<Segment>& segments)
+{
+    return transferSegments(segments, false);
+}
+
+bool NativeDevice::writeSegments(const QVector<Segment>& segments)
+{
+    return transferSegments(segments, true);
+}
+
+/** Transfers segments with as few preadv() or pwritev() calls as possible: segments that
+    follow each other on the device go into one call, up to IOV_MAX of them.
+*/
+bool NativeDevice::transferSegments(const QVector<Segment>& segments, bool write)
+{
+    if (!isExclusive())
+        return false;
+
+    QVector<struct iovec> iov;
+
+    for (qint32 i = 0; i < segments.size(); ) {
+        const qint64 start = segments[i].offset * m_SectorSize;
+        qint64 end = start;
+
+        iov.clear();
+
+        while (i < segments.size() && iov.size() < IOV_MAX && segments[i].offset * m_SectorSize == end) {
+            struct iovec v;
+            v.iov_base = segments[i].buffer;
+            v.iov_len = segments[i].numSectors * m_SectorSize;
+
+            iov.append(v);
+            end += v.iov_len;
+            i++;
+        }
+
+        if (!transferAll(fd(), iov.data(), iov.size(), start, write))
+            return false;
+    }
+
+    return true;
+}
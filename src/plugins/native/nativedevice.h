@@ -0,0 +1,74 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#if !defined(NATIVEDEVICE__H)
+
+#define NATIVEDEVICE__H
+
+#include "backend/corebackenddevice.h"
+
+#include <QtGlobal>
+
+class Partition;
+class PartitionTable;
+class Report;
+class CoreBackendPartitionTable;
+
+/** A device accessed through plain file descriptor I/O.
+    @author Andrius Štikonas <andrius@stikonas.eu>
+*/
+class NativeDevice : public CoreBackendDevice
+{
+    Q_DISABLE_COPY(NativeDevice);
+
+    friend class NativePartitionTable;
+
+public:
+    NativeDevice(const QString& deviceNode);
+    ~NativeDevice();
+
+public:
+    bool open() override;
+    bool openExclusive() override;
+    bool close() override;
+
+    CoreBackendPartitionTable* openPartitionTable() override;
+
+    bool createPartitionTable(Report& report, const PartitionTable& ptable) override;
+
+    bool readSectors(void* buffer, qint64 offset, qint64 numSectors) override;
+    bool writeSectors(void* buffer, qint64 offset, qint64 numSectors) override;
+    bool sync() override;
+
+    bool readSegments(const QVector<Segment>& segments) override;
+    bool writeSegments(const QVector<Segment>& segments) override;
+
+protected:
+    int fd() const {
+        return m_Fd;
+    }
+
+private:
+    bool open(int flags);
+    bool transferSegments(const QVector<Segment>& segments, bool write);
+
+private:
+    int m_Fd;
+    qint32 m_SectorSize;
+};
+
+#endif
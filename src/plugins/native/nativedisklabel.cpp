@@ -0,0 +1,1002 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#include "plugins/native/nativedisklabel.h"
+
+#include "backend/corebackenddevice.h"
+
+#include <QByteArray>
+#include <QVector>
+#include <QtEndian>
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+const qint32 mbrTableOffset = 446;
+const qint32 mbrEntrySize = 16;
+const qint32 gptEntrySize = 128;
+const quint32 gptDefaultEntryCount = 128;
+const quint32 gptMaxEntryCount = 4096;
+const char gptSignature[] = "EFI PART";
+
+struct Crc32Table
+{
+    Crc32Table() {
+        for (quint32 i = 0; i < 256; i++) {
+            quint32 c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+            value[i] = c;
+        }
+    }
+
+    quint32 value[256];
+};
+
+/** Well known GPT partition type GUIDs that libparted exposes as flags. */
+const struct {
+    PartitionTable::Flag flag;
+    QUuid guid;
+} gptTypeFlags[] = {
+    { PartitionTable::FlagBoot, QUuid(0xc12a7328, 0xf81f, 0x11d2, 0xba, 0x4b, 0x00, 0xa0, 0xc9, 0x3e, 0xc9, 0x3b) },
+    { PartitionTable::FlagEsp, QUuid(0xc12a7328, 0xf81f, 0x11d2, 0xba, 0x4b, 0x00, 0xa0, 0xc9, 0x3e, 0xc9, 0x3b) },
+    { PartitionTable::FlagLvm, QUuid(0xe6d6d379, 0xf507, 0x44c2, 0xa2, 0x3c, 0x23, 0x8f, 0x2a, 0x3d, 0xf9, 0x28) },
+    { PartitionTable::FlagRaid, QUuid(0xa19d880f, 0x05fc, 0x4d3b, 0xa0, 0x06, 0x74, 0x3f, 0x0f, 0x84, 0x91, 0x1e) },
+    { PartitionTable::FlagBiosGrub, QUuid(0x21686148, 0x6449, 0x6e6f, 0x74, 0x4e, 0x65, 0x65, 0x64, 0x45, 0x46, 0x49) },
+    { PartitionTable::FlagMsftReserved, QUuid(0xe3c9e316, 0x0b5c, 0x4db8, 0x81, 0x7d, 0xf9, 0x2d, 0xf0, 0x02, 0x15, 0xae) },
+    { PartitionTable::FlagMsftData, QUuid(0xebd0a0a2, 0xb9e5, 0x4433, 0x87, 0xc0, 0x68, 0xb6, 0xb7, 0x26, 0x99, 0xc7) },
+    { PartitionTable::FlagDiag, QUuid(0xde94bba4, 0x06d1, 0x4d40, 0xa1, 0x6a, 0xbf, 0xd5, 0x01, 0x79, 0xd6, 0xac) },
+    { PartitionTable::FlagPrep, QUuid(0x9e1a2d38, 0xc612, 0x4316, 0xaa, 0x26, 0x8b, 0x49, 0x52, 0x1e, 0x5a, 0x8b) },
+    { PartitionTable::FlagIrst, QUuid(0xd3bfe2de, 0x3daf, 0x11df, 0xba, 0x40, 0xe3, 0xa5, 0x56, 0xd8, 0x95, 0x93) },
+    { PartitionTable::FlagAppleTvRecovery, QUuid(0x5265636f, 0x7665, 0x11aa, 0xaa, 0x11, 0x00, 0x30, 0x65, 0x43, 0xec, 0xac) },
+    { PartitionTable::FlagHpService, QUuid(0xe2a1e728, 0x32e3, 0x11d6, 0xa6, 0x82, 0x7b, 0x03, 0xa0, 0x00, 0x00, 0x00) }
+};
+
+const QUuid gptLinuxData(0x0fc63daf, 0x8483, 0x4772, 0x8e, 0x79, 0x3d, 0x69, 0xd8, 0x47, 0x7d, 0xe4);
+const QUuid gptLinuxSwap(0x0657fd6d, 0xa4ab, 0x43c4, 0x84, 0xe5, 0x09, 0x33, 0xc8, 0x4b, 0x4f, 0x4f);
+const QUuid gptAppleHfs(0x48465300, 0x0000, 0x11aa, 0xaa, 0x11, 0x00, 0x30, 0x65, 0x43, 0xec, 0xac);
+
+const quint64 gptAttrLegacyBoot = Q_UINT64_C(1) << 2;
+const quint64 gptAttrHidden = Q_UINT64_C(1) << 62;
+
+/** MBR system ids that libparted exposes as flags. */
+const struct {
+    PartitionTable::Flag flag;
+    quint8 systemId;
+} mbrTypeFlags[] = {
+    { PartitionTable::FlagLvm, 0x8e },
+    { PartitionTable::FlagRaid, 0xfd },
+    { PartitionTable::FlagPrep, 0x41 },
+    { PartitionTable::FlagEsp, 0xef }
+};
+
+/** Pairs of MBR system ids that only differ in their hidden resp. LBA variant. */
+const quint8 mbrHiddenPairs[][2] = {
+    { 0x01, 0x11 }, { 0x04, 0x14 }, { 0x06, 0x16 }, { 0x07, 0x17 }, { 0x0b, 0x1b }, { 0x0c, 0x1c }, { 0x0e, 0x1e }
+};
+
+const quint8 mbrLbaPairs[][2] = {
+    { 0x06, 0x0e }, { 0x0b, 0x0c }, { 0x16, 0x1e }, { 0x1b, 0x1c }, { 0x05, 0x0f }
+};
+
+/** Switch an MBR system id between the plain and the hidden resp. LBA variant. */
+template <size_t N>
+void toggleVariant(quint8& systemId, const quint8 (&pairs)[N][2], bool state)
+{
+    for (const auto &pair : pairs)
+        if (pair[state ? 0 : 1] == systemId) {
+            systemId = pair[state ? 1 : 0];
+            return;
+        }
+}
+
+bool isExtendedId(quint8 id)
+{
+    return id == 0x05 || id == 0x0f || id == 0x85;
+}
+
+QByteArray readAt(int fd, qint64 offset, qint64 length)
+{
+    QByteArray buffer(length, 0);
+    qint64 done = 0;
+
+    while (done < length) {
+        const ssize_t n = pread(fd, buffer.data() + done, length - done, offset + done);
+        if (n <= 0)
+            break;
+        done += n;
+    }
+
+    buffer.truncate(done);
+    return buffer;
+}
+
+QUuid guidFromBytes(const uchar* p)
+{
+    return QUuid(qFromLittleEndian<quint32>(p), qFromLittleEndian<quint16>(p + 4), qFromLittleEndian<quint16>(p + 6),
+                 p[8], p[9], p[10], p[11], p[12], p[13], p[14], p[15]);
+}
+
+void guidToBytes(const QUuid& guid, uchar* p)
+{
+    qToLittleEndian<quint32>(guid.data1, p);
+    qToLittleEndian<quint16>(guid.data2, p + 4);
+    qToLittleEndian<quint16>(guid.data3, p + 6);
+    std::copy(guid.data4, guid.data4 + 8, p + 8);
+}
+
+void fillMbrEntry(uchar* p, quint8 status, quint8 systemId, qint64 start, qint64 length)
+{
+    // CHS addressing is long dead, mark both ends as "use LBA" the way other tools do
+    p[0] = status;
+    p[1] = 0xfe;
+    p[2] = 0xff;
+    p[3] = 0xff;
+    p[4] = systemId;
+    p[5] = 0xfe;
+    p[6] = 0xff;
+    p[7] = 0xff;
+    qToLittleEndian<quint32>(static_cast<quint32>(start), p + 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(length), p + 12);
+}
+
+bool isLess(const NativeDiskLabel::Entry& a, const NativeDiskLabel::Entry& b)
+{
+    const bool al = a.role.testFlag(PartitionRole::Logical);
+    const bool bl = b.role.testFlag(PartitionRole::Logical);
+
+    if (al != bl)
+        return bl;
+
+    return a.firstSector < b.firstSector;
+}
+
+}
+
+NativeDiskLabel::NativeDiskLabel() :
+    m_Type(PartitionTable::unknownTableType),
+    m_SectorSize(512),
+    m_TotalSectors(0),
+    m_FirstUsable(0),
+    m_LastUsable(-1),
+    m_DiskSignature(0),
+    m_GptEntryCount(gptDefaultEntryCount)
+{
+}
+
+/** Determine the logical sector size and the size of an open device or image file.
+    @param fd the file descriptor to look at
+    @param sectorSize returns the logical sector size in bytes
+    @param totalSectors returns the size in logical sectors
+    @return true on success
+*/
+bool NativeDiskLabel::probe(int fd, qint32& sectorSize, qint64& totalSectors)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+        return false;
+
+    quint64 bytes = 0;
+    int size = 512;
+
+    if (S_ISBLK(st.st_mode)) {
+        if (ioctl(fd, BLKSSZGET, &size) != 0 || size < 512)
+            size = 512;
+        if (ioctl(fd, BLKGETSIZE64, &bytes) != 0)
+            return false;
+    } else if (S_ISREG(st.st_mode))
+        bytes = st.st_size;
+    else
+        return false;
+
+    sectorSize = size;
+    totalSectors = bytes / size;
+
+    return totalSectors > 0;
+}
+
+/** Standard (IEEE 802.3) CRC32 as required by the GPT headers.
+    @param data the data to checksum
+    @param length number of bytes
+    @param crc a previous checksum to continue from
+    @return the checksum
+*/
+quint32 NativeDiskLabel::crc32(const void* data, qint64 length, quint32 crc)
+{
+    static const Crc32Table table;
+
+    const uchar* p = static_cast<const uchar*>(data);
+    crc = ~crc;
+
+    while (length-- > 0)
+        crc = table.value[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+
+    return ~crc;
+}
+
+/** Forget all partitions and start over with an empty table of the given type.
+    The MBR boot code of the device, if any, is kept.
+    @param type msdos or gpt
+*/
+void NativeDiskLabel::reset(PartitionTable::TableType type)
+{
+    m_Type = type == PartitionTable::msdos_sectorbased ? PartitionTable::msdos : type;
+    m_Entries.clear();
+    m_GptEntryCount = gptDefaultEntryCount;
+
+    if (m_Type == PartitionTable::gpt) {
+        const qint64 entrySectors = (m_GptEntryCount * gptEntrySize + m_SectorSize - 1) / m_SectorSize;
+        m_FirstUsable = 2 + entrySectors;
+        m_LastUsable = m_TotalSectors - 2 - entrySectors;
+        m_DiskGuid = QUuid::createUuid();
+    } else {
+        m_FirstUsable = 1;
+        m_LastUsable = m_TotalSectors - 1;
+        m_DiskSignature = QUuid::createUuid().data1;
+    }
+}
+
+/** Read the partition table from a device.
+    @param fd file descriptor of the device, open for reading
+    @return true if the device could be read, even if no supported table was found on it
+*/
+bool NativeDiskLabel::read(int fd)
+{
+    m_Type = PartitionTable::unknownTableType;
+    m_Entries.clear();
+
+    if (!probe(fd, m_SectorSize, m_TotalSectors))
+        return false;
+
+    // MBR, primary GPT header and a default sized entry array in one go
+    const qint64 headSectors = qMin<qint64>(2 + (gptDefaultEntryCount * gptEntrySize + m_SectorSize - 1) / m_SectorSize, m_TotalSectors);
+    const QByteArray head = readAt(fd, 0, headSectors * m_SectorSize);
+
+    if (head.size() < m_SectorSize)
+        return false;
+
+    const uchar* mbr = reinterpret_cast<const uchar*>(head.constData());
+
+    if (mbr[510] != 0x55 || mbr[511] != 0xaa)
+        return true;
+
+    bool protective = false;
+    for (qint32 i = 0; i < 4; i++) {
+        const uchar* p = mbr + mbrTableOffset + i * mbrEntrySize;
+
+        // a boot sector of a file system on the whole device, not a partition table
+        if (p[0] != 0x00 && p[0] != 0x80)
+            return true;
+
+        if (p[4] == 0xee)
+            protective = true;
+    }
+
+    m_BootCode = head.left(440);
+    m_DiskSignature = qFromLittleEndian<quint32>(mbr + 440);
+
+    if (protective)
+        return readGpt(fd, head);
+
+    return readMsdos(fd, head);
+}
+
+bool NativeDiskLabel::readMsdos(int fd, const QByteArray& mbr)
+{
+    m_Type = PartitionTable::msdos;
+    m_FirstUsable = 1;
+    m_LastUsable = m_TotalSectors - 1;
+
+    const uchar* data = reinterpret_cast<const uchar*>(mbr.constData());
+    qint64 extendedFirst = -1;
+    qint64 extendedLast = -1;
+
+    for (qint32 i = 0; i < 4; i++) {
+        const uchar* p = data + mbrTableOffset + i * mbrEntrySize;
+        const quint32 start = qFromLittleEndian<quint32>(p + 8);
+        const quint32 length = qFromLittleEndian<quint32>(p + 12);
+
+        if (p[4] == 0 || length == 0)
+            continue;
+
+        Entry e;
+        e.number = i + 1;
+        e.firstSector = start;
+        e.lastSector = static_cast<qint64>(start) + length - 1;
+        e.systemId = p[4];
+        e.bootable = p[0] == 0x80;
+        e.role = isExtendedId(p[4]) ? PartitionRole::Extended : PartitionRole::Primary;
+
+        if (e.role == PartitionRole::Extended && extendedFirst < 0) {
+            extendedFirst = e.firstSector;
+            extendedLast = e.lastSector;
+        }
+
+        m_Entries.append(e);
+    }
+
+    // follow the chain of extended boot records; the hop count guards against loops
+    qint64 ebr = extendedFirst;
+    qint32 number = 5;
+
+    for (qint32 hops = 0; ebr >= 0 && hops < 1024; hops++) {
+        const QByteArray sector = readAt(fd, ebr * m_SectorSize, m_SectorSize);
+        if (sector.size() < 512)
+            break;
+
+        const uchar* s = reinterpret_cast<const uchar*>(sector.constData());
+        if (s[510] != 0x55 || s[511] != 0xaa)
+            break;
+
+        const uchar* p = s + mbrTableOffset;
+        const quint32 length = qFromLittleEndian<quint32>(p + 12);
+
+        if (p[4] != 0 && length != 0) {
+            Entry e;
+            e.number = number++;
+            e.firstSector = ebr + qFromLittleEndian<quint32>(p + 8);
+            e.lastSector = e.firstSector + length - 1;
+            e.systemId = p[4];
+            e.bootable = p[0] == 0x80;
+            e.role = PartitionRole::Logical;
+            m_Entries.append(e);
+        }
+
+        const uchar* next = p + mbrEntrySize;
+        if (next[4] == 0 || qFromLittleEndian<quint32>(next + 8) == 0)
+            break;
+
+        ebr = extendedFirst + qFromLittleEndian<quint32>(next + 8);
+        if (ebr > extendedLast)
+            break;
+    }
+
+    sortEntries();
+
+    return true;
+}
+
+bool NativeDiskLabel::readGpt(int fd, const QByteArray& head)
+{
+    const uchar* primary = head.size() >= 2 * m_SectorSize ? reinterpret_cast<const uchar*>(head.constData()) + m_SectorSize : nullptr;
+
+    if (primary && readGptHeader(fd, primary, 1, head))
+        return true;
+
+    const QByteArray backup = readAt(fd, (m_TotalSectors - 1) * m_SectorSize, m_SectorSize);
+
+    if (backup.size() == m_SectorSize && readGptHeader(fd, reinterpret_cast<const uchar*>(backup.constData()), m_TotalSectors - 1, QByteArray()))
+        return true;
+
+    m_Type = PartitionTable::unknownTableType;
+    m_Entries.clear();
+
+    return true;
+}
+
+/** Validate a GPT header and read the partition entries it points to.
+    @param fd the device
+    @param header the header sector
+    @param lba the sector the header was read from
+    @param preloaded the start of the device as read by read(), used if the entry array is in it
+    @return true if header and entries are valid
+*/
+bool NativeDiskLabel::readGptHeader(int fd, const uchar* header, qint64 lba, const QByteArray& preloaded)
+{
+    if (!std::equal(gptSignature, gptSignature + 8, header))
+        return false;
+
+    const quint32 headerSize = qFromLittleEndian<quint32>(header + 12);
+    if (headerSize < 92 || headerSize > static_cast<quint32>(m_SectorSize))
+        return false;
+
+    QByteArray copy(reinterpret_cast<const char*>(header), headerSize);
+    qToLittleEndian<quint32>(0, reinterpret_cast<uchar*>(copy.data()) + 16);
+    if (crc32(copy.constData(), copy.size()) != qFromLittleEndian<quint32>(header + 16))
+        return false;
+
+    if (static_cast<qint64>(qFromLittleEndian<quint64>(header + 24)) != lba)
+        return false;
+
+    const qint64 entriesLba = qFromLittleEndian<quint64>(header + 72);
+    const quint32 count = qFromLittleEndian<quint32>(header + 80);
+    const quint32 entrySize = qFromLittleEndian<quint32>(header + 84);
+
+    if (entrySize != gptEntrySize || count == 0 || count > gptMaxEntryCount)
+        return false;
+
+    const qint64 bytes = static_cast<qint64>(count) * entrySize;
+    const QByteArray entries = (entriesLba == 2 && preloaded.size() >= 2 * m_SectorSize + bytes)
+                               ? preloaded.mid(2 * m_SectorSize, bytes)
+                               : readAt(fd, entriesLba * m_SectorSize, bytes);
+
+    if (entries.size() != bytes || crc32(entries.constData(), bytes) != qFromLittleEndian<quint32>(header + 88))
+        return false;
+
+    m_Type = PartitionTable::gpt;
+    m_FirstUsable = qFromLittleEndian<quint64>(header + 40);
+    m_LastUsable = qFromLittleEndian<quint64>(header + 48);
+    m_DiskGuid = guidFromBytes(header + 56);
+    m_GptEntryCount = count;
+    m_Entries.clear();
+
+    for (quint32 i = 0; i < count; i++) {
+        const uchar* p = reinterpret_cast<const uchar*>(entries.constData()) + i * entrySize;
+        const QUuid type = guidFromBytes(p);
+
+        if (type.isNull())
+            continue;
+
+        Entry e;
+        e.number = i + 1;
+        e.typeGuid = type;
+        e.uniqueGuid = guidFromBytes(p + 16);
+        e.firstSector = qFromLittleEndian<quint64>(p + 32);
+        e.lastSector = qFromLittleEndian<quint64>(p + 40);
+        e.attributes = qFromLittleEndian<quint64>(p + 48);
+        e.role = PartitionRole::Primary;
+
+        for (qint32 j = 0; j < 36; j++) {
+            const quint16 c = qFromLittleEndian<quint16>(p + 56 + 2 * j);
+            if (c == 0)
+                break;
+            e.name += QChar(c);
+        }
+
+        m_Entries.append(e);
+    }
+
+    sortEntries();
+
+    return true;
+}
+
+/** Write the partition table to a device and flush it.
+    @param fd file descriptor of the device, open for writing
+    @return true on success
+*/
+bool NativeDiskLabel::write(CoreBackendDevice& device) const
+{
+    bool rval = false;
+
+    if (m_Type == PartitionTable::gpt)
+        rval = writeGpt(device);
+    else if (m_Type == PartitionTable::msdos)
+        rval = writeMsdos(device);
+
+    return rval && device.sync();
+}
+
+bool NativeDiskLabel::writeMsdos(CoreBackendDevice& device) const
+{
+    QByteArray mbr(m_SectorSize, 0);
+    mbr.replace(0, qMin(m_BootCode.size(), 440), m_BootCode.left(440));
+
+    uchar* data = reinterpret_cast<uchar*>(mbr.data());
+    qToLittleEndian<quint32>(m_DiskSignature, data + 440);
+    data[510] = 0x55;
+    data[511] = 0xaa;
+
+    const Entry* ext = nullptr;
+    QList<const Entry*> logicals;
+
+    for (const auto &e : m_Entries) {
+        if (e.role.testFlag(PartitionRole::Logical)) {
+            logicals.append(&e);
+            continue;
+        }
+
+        if (e.number < 1 || e.number > 4 || e.lastSector >= Q_INT64_C(0x100000000))
+            return false;
+
+        if (e.role.testFlag(PartitionRole::Extended))
+            ext = &e;
+
+        fillMbrEntry(data + mbrTableOffset + (e.number - 1) * mbrEntrySize, e.bootable ? 0x80 : 0x00, e.systemId, e.firstSector, e.lastSector - e.firstSector + 1);
+    }
+
+    if (ext == nullptr && !logicals.isEmpty())
+        return false;
+
+    // Every logical partition gets its boot record in the sector right in front of it,
+    // except for the first one which lives at the very start of the extended partition.
+    QList<qint64> ebrs;
+    qint64 previousLast = ext ? ext->firstSector - 1 : -1;
+
+    for (qint32 i = 0; i < logicals.size(); i++) {
+        const qint64 ebr = i == 0 ? ext->firstSector : logicals[i]->firstSector - 1;
+
+        if (ebr <= previousLast || ebr >= logicals[i]->firstSector || logicals[i]->lastSector > ext->lastSector)
+            return false;
+
+        // EBR entries hold starts and lengths relative to the EBR resp. the extended partition
+        // in 32 bits; those never exceed the absolute last sector, which has to fit as well
+        if (logicals[i]->lastSector >= Q_INT64_C(0x100000000))
+            return false;
+
+        ebrs.append(ebr);
+        previousLast = logicals[i]->lastSector;
+    }
+
+    // one boot record per logical partition, or an empty one if there are none
+    QVector<QByteArray> records(ext ? qMax(logicals.size(), 1) : 0, QByteArray(m_SectorSize, 0));
+    QVector<CoreBackendDevice::Segment> segments;
+
+    // write the logical chain back to front so the MBR only points at complete records
+    for (qint32 i = records.size() - 1; i >= 0; i--) {
+        uchar* r = reinterpret_cast<uchar*>(records[i].data());
+
+        if (!logicals.isEmpty()) {
+            const Entry* l = logicals[i];
+
+            fillMbrEntry(r + mbrTableOffset, l->bootable ? 0x80 : 0x00, l->systemId, l->firstSector - ebrs[i], l->lastSector - l->firstSector + 1);
+
+            if (i + 1 < logicals.size())
+                fillMbrEntry(r + mbrTableOffset + mbrEntrySize, 0x00, 0x05, ebrs[i + 1] - ext->firstSector, logicals[i + 1]->lastSector - ebrs[i + 1] + 1);
+        }
+
+        r[510] = 0x55;
+        r[511] = 0xaa;
+
+        segments.append({ r, logicals.isEmpty() ? ext->firstSector : ebrs[i], 1 });
+    }
+
+    segments.append({ mbr.data(), 0, 1 });
+
+    return device.writeSegments(segments);
+}
+
+bool NativeDiskLabel::writeGpt(CoreBackendDevice& device) const
+{
+    const qint64 entryBytes = static_cast<qint64>(m_GptEntryCount) * gptEntrySize;
+    const qint64 entrySectors = (entryBytes + m_SectorSize - 1) / m_SectorSize;
+    const qint64 backupLba = m_TotalSectors - 1;
+
+    if (m_FirstUsable < 2 + entrySectors || m_LastUsable > backupLba - 1 - entrySectors)
+        return false;
+
+    QByteArray entries(entrySectors * m_SectorSize, 0);
+
+    for (const auto &e : m_Entries) {
+        if (e.number < 1 || static_cast<quint32>(e.number) > m_GptEntryCount)
+            return false;
+
+        uchar* p = reinterpret_cast<uchar*>(entries.data()) + (e.number - 1) * gptEntrySize;
+        guidToBytes(e.typeGuid, p);
+        guidToBytes(e.uniqueGuid, p + 16);
+        qToLittleEndian<quint64>(e.firstSector, p + 32);
+        qToLittleEndian<quint64>(e.lastSector, p + 40);
+        qToLittleEndian<quint64>(e.attributes, p + 48);
+
+        for (qint32 j = 0; j < qMin(e.name.size(), 36); j++)
+            qToLittleEndian<quint16>(e.name.at(j).unicode(), p + 56 + 2 * j);
+    }
+
+    const quint32 entriesCrc = crc32(entries.constData(), entryBytes);
+
+    auto makeHeader = [&] (qint64 current, qint64 alternate, qint64 entriesLba) {
+        QByteArray header(m_SectorSize, 0);
+        uchar* h = reinterpret_cast<uchar*>(header.data());
+
+        std::copy(gptSignature, gptSignature + 8, h);
+        qToLittleEndian<quint32>(0x00010000, h + 8);
+        qToLittleEndian<quint32>(92, h + 12);
+        qToLittleEndian<quint64>(current, h + 24);
+        qToLittleEndian<quint64>(alternate, h + 32);
+        qToLittleEndian<quint64>(m_FirstUsable, h + 40);
+        qToLittleEndian<quint64>(m_LastUsable, h + 48);
+        guidToBytes(m_DiskGuid, h + 56);
+        qToLittleEndian<quint64>(entriesLba, h + 72);
+        qToLittleEndian<quint32>(m_GptEntryCount, h + 80);
+        qToLittleEndian<quint32>(gptEntrySize, h + 84);
+        qToLittleEndian<quint32>(entriesCrc, h + 88);
+        qToLittleEndian<quint32>(crc32(h, 92), h + 16);
+
+        return header;
+    };
+
+    QByteArray protectiveMbr(m_SectorSize, 0);
+    protectiveMbr.replace(0, qMin(m_BootCode.size(), 440), m_BootCode.left(440));
+
+    uchar* mbr = reinterpret_cast<uchar*>(protectiveMbr.data());
+    fillMbrEntry(mbr + mbrTableOffset, 0x00, 0xee, 1, qMin<qint64>(m_TotalSectors - 1, Q_INT64_C(0xffffffff)));
+    mbr[510] = 0x55;
+    mbr[511] = 0xaa;
+
+    QByteArray primaryHeader = makeHeader(1, backupLba, 2);
+    QByteArray backupHeader = makeHeader(backupLba, 1, backupLba - entrySectors);
+
+    // both copies are contiguous runs of sectors, so each of them goes out in a single call
+    const QVector<CoreBackendDevice::Segment> primary = {
+        { protectiveMbr.data(), 0, 1 },
+        { primaryHeader.data(), 1, 1 },
+        { entries.data(), 2, entrySectors }
+    };
+    const QVector<CoreBackendDevice::Segment> backup = {
+        { entries.data(), backupLba - entrySectors, entrySectors },
+        { backupHeader.data(), backupLba, 1 }
+    };
+
+    return device.writeSegments(primary) && device.sync() && device.writeSegments(backup);
+}
+
+/** @return the number of primary slots in this table */
+qint32 NativeDiskLabel::maxPrimaries() const
+{
+    return m_Type == PartitionTable::gpt ? static_cast<qint32>(m_GptEntryCount) : 4;
+}
+
+/** Find the partition a sector belongs to.
+    @param sector the sector to look for
+    @param extended if true, return the extended partition regardless of the sector
+    @return the innermost partition containing the sector or nullptr if there is none
+*/
+NativeDiskLabel::Entry* NativeDiskLabel::findBySector(qint64 sector, bool extended)
+{
+    if (extended)
+        return this->extended();
+
+    Entry* container = nullptr;
+
+    for (auto &e : m_Entries) {
+        if (sector < e.firstSector || sector > e.lastSector)
+            continue;
+
+        if (!e.role.testFlag(PartitionRole::Extended))
+            return &e;
+
+        container = &e;
+    }
+
+    return container;
+}
+
+const NativeDiskLabel::Entry* NativeDiskLabel::findByNumber(qint32 number) const
+{
+    for (const auto &e : m_Entries)
+        if (e.number == number)
+            return &e;
+
+    return nullptr;
+}
+
+/** @return the extended partition or nullptr if there is none */
+NativeDiskLabel::Entry* NativeDiskLabel::extended()
+{
+    for (auto &e : m_Entries)
+        if (e.role.testFlag(PartitionRole::Extended))
+            return &e;
+
+    return nullptr;
+}
+
+/** Check if a partition with the given extent could be placed in the table.
+    @param firstSector the first sector
+    @param lastSector the last sector
+    @param role primary, extended or logical
+    @param ignore an existing partition to leave out of the overlap checks
+    @return true if the extent is usable and does not overlap anything else
+*/
+bool NativeDiskLabel::fits(qint64 firstSector, qint64 lastSector, PartitionRole::Roles role, const Entry* ignore) const
+{
+    if (firstSector > lastSector || firstSector < m_FirstUsable || lastSector > m_LastUsable)
+        return false;
+
+    const bool logical = role.testFlag(PartitionRole::Logical);
+    bool contained = !logical;
+
+    for (const auto &x : m_Entries) {
+        if (&x == ignore)
+            continue;
+
+        // logicals need the first sector of their extended partition for its boot record
+        if (logical && x.role.testFlag(PartitionRole::Extended) && firstSector > x.firstSector && lastSector <= x.lastSector)
+            contained = true;
+
+        if (role.testFlag(PartitionRole::Extended) && x.role.testFlag(PartitionRole::Logical) && (x.firstSector <= firstSector || x.lastSector > lastSector))
+            return false;
+
+        if (x.role.testFlag(PartitionRole::Logical) == logical && firstSector <= x.lastSector && x.firstSector <= lastSector)
+            return false;
+    }
+
+    return contained;
+}
+
+/** Add a new partition. If it has no number yet, the lowest free slot is used.
+    Logical partitions are renumbered in on-disk order, just like the kernel does.
+    @param e the new partition
+    @return the number the new partition got or -1 if the table is full
+*/
+qint32 NativeDiskLabel::add(const Entry& e)
+{
+    if (!fits(e.firstSector, e.lastSector, e.role))
+        return -1;
+
+    Entry n = e;
+
+    if (n.role.testFlag(PartitionRole::Logical))
+        n.number = 0;
+    else if (n.number < 1) {
+        for (qint32 i = 1; i <= maxPrimaries() && n.number < 1; i++)
+            if (findByNumber(i) == nullptr)
+                n.number = i;
+
+        if (n.number < 1)
+            return -1;
+    }
+
+    if (m_Type == PartitionTable::gpt && n.uniqueGuid.isNull())
+        n.uniqueGuid = QUuid::createUuid();
+
+    m_Entries.append(n);
+    sortEntries();
+
+    for (const auto &x : m_Entries)
+        if (x.firstSector == n.firstSector && x.role == n.role)
+            return x.number;
+
+    return -1;
+}
+
+/** Remove a partition. Removing the extended partition also removes all logicals.
+    @param firstSector the partition's first sector
+    @param extended true if the extended partition is to be removed
+    @return true if a partition was removed
+*/
+bool NativeDiskLabel::remove(qint64 firstSector, bool extended)
+{
+    for (qint32 i = 0; i < m_Entries.size(); i++) {
+        if (m_Entries[i].firstSector != firstSector || m_Entries[i].role.testFlag(PartitionRole::Extended) != extended)
+            continue;
+
+        m_Entries.removeAt(i);
+
+        if (extended)
+            for (qint32 j = m_Entries.size() - 1; j >= 0; j--)
+                if (m_Entries[j].role.testFlag(PartitionRole::Logical))
+                    m_Entries.removeAt(j);
+
+        sortEntries();
+
+        return true;
+    }
+
+    return false;
+}
+
+/** Move or resize a partition.
+    @param e the partition
+    @param firstSector the new first sector
+    @param lastSector the new last sector
+    @return true if the new extent fits
+*/
+bool NativeDiskLabel::setGeometry(Entry& e, qint64 firstSector, qint64 lastSector)
+{
+    if (!fits(firstSector, lastSector, e.role, &e))
+        return false;
+
+    e.firstSector = firstSector;
+    e.lastSector = lastSector;
+    sortEntries();
+
+    return true;
+}
+
+void NativeDiskLabel::sortEntries()
+{
+    std::stable_sort(m_Entries.begin(), m_Entries.end(), isLess);
+    renumberLogicals();
+}
+
+void NativeDiskLabel::renumberLogicals()
+{
+    qint32 number = 5;
+
+    for (auto &e : m_Entries)
+        if (e.role.testFlag(PartitionRole::Logical))
+            e.number = number++;
+}
+
+/** @return the flags that can be set on a partition */
+PartitionTable::Flags NativeDiskLabel::availableFlags(const Entry& e) const
+{
+    PartitionTable::Flags flags;
+
+    if (m_Type == PartitionTable::gpt) {
+        for (const auto &f : gptTypeFlags)
+            flags |= f.flag;
+
+        flags |= PartitionTable::FlagHidden | PartitionTable::FlagLegacyBoot;
+    } else if (e.role.testFlag(PartitionRole::Extended))
+        flags = PartitionTable::FlagBoot | PartitionTable::FlagLba;
+    else {
+        for (const auto &f : mbrTypeFlags)
+            flags |= f.flag;
+
+        flags |= PartitionTable::FlagBoot | PartitionTable::FlagHidden | PartitionTable::FlagLba;
+    }
+
+    return flags;
+}
+
+/** @return the flags currently set on a partition */
+PartitionTable::Flags NativeDiskLabel::activeFlags(const Entry& e) const
+{
+    PartitionTable::Flags flags;
+
+    if (m_Type == PartitionTable::gpt) {
+        for (const auto &f : gptTypeFlags)
+            if (f.guid == e.typeGuid)
+                flags |= f.flag;
+
+        if (e.attributes & gptAttrHidden)
+            flags |= PartitionTable::FlagHidden;
+        if (e.attributes & gptAttrLegacyBoot)
+            flags |= PartitionTable::FlagLegacyBoot;
+
+        return flags;
+    }
+
+    if (e.bootable)
+        flags |= PartitionTable::FlagBoot;
+
+    for (const auto &f : mbrTypeFlags)
+        if (f.systemId == e.systemId)
+            flags |= f.flag;
+
+    for (const auto &pair : mbrHiddenPairs)
+        if (pair[1] == e.systemId)
+            flags |= PartitionTable::FlagHidden;
+
+    for (const auto &pair : mbrLbaPairs)
+        if (pair[1] == e.systemId)
+            flags |= PartitionTable::FlagLba;
+
+    return flags;
+}
+
+/** Set or clear a flag. Flags that are encoded in the partition type fall back to the
+    generic Linux type when cleared, but only if they were set in the first place.
+    @return false if the flag is not available for the partition
+*/
+bool NativeDiskLabel::setFlag(Entry& e, PartitionTable::Flag flag, bool state)
+{
+    if (!(availableFlags(e) & flag))
+        return false;
+
+    if (static_cast<bool>(activeFlags(e) & flag) == state)
+        return true;
+
+    if (m_Type == PartitionTable::gpt) {
+        if (flag == PartitionTable::FlagHidden || flag == PartitionTable::FlagLegacyBoot) {
+            const quint64 bit = flag == PartitionTable::FlagHidden ? gptAttrHidden : gptAttrLegacyBoot;
+            e.attributes = state ? e.attributes | bit : e.attributes & ~bit;
+            return true;
+        }
+
+        e.typeGuid = gptLinuxData;
+
+        if (state)
+            for (const auto &f : gptTypeFlags)
+                if (f.flag == flag)
+                    e.typeGuid = f.guid;
+
+        return true;
+    }
+
+    if (flag == PartitionTable::FlagBoot) {
+        // only one partition may be marked active
+        if (state)
+            for (auto &x : m_Entries)
+                x.bootable = false;
+
+        e.bootable = state;
+        return true;
+    }
+
+    if (flag == PartitionTable::FlagHidden) {
+        toggleVariant(e.systemId, mbrHiddenPairs, state);
+        return true;
+    }
+
+    if (flag == PartitionTable::FlagLba) {
+        toggleVariant(e.systemId, mbrLbaPairs, state);
+        return true;
+    }
+
+    e.systemId = 0x83;
+
+    if (state)
+        for (const auto &f : mbrTypeFlags)
+            if (f.flag == flag)
+                e.systemId = f.systemId;
+
+    return true;
+}
+
+/** Set the partition type from the file system that is going to be on it.
+    @param e the partition
+    @param t the file system type
+*/
+void NativeDiskLabel::setSystemType(Entry& e, FileSystem::Type t) const
+{
+    if (m_Type == PartitionTable::gpt) {
+        switch (t) {
+        case FileSystem::LinuxSwap:
+            e.typeGuid = gptLinuxSwap;
+            break;
+        case FileSystem::Fat16:
+        case FileSystem::Fat32:
+        case FileSystem::Ntfs:
+        case FileSystem::Exfat:
+            e.typeGuid = QUuid(0xebd0a0a2, 0xb9e5, 0x4433, 0x87, 0xc0, 0x68, 0xb6, 0xb7, 0x26, 0x99, 0xc7);
+            break;
+        case FileSystem::Hfs:
+        case FileSystem::HfsPlus:
+            e.typeGuid = gptAppleHfs;
+            break;
+        case FileSystem::Lvm2_PV:
+            e.typeGuid = QUuid(0xe6d6d379, 0xf507, 0x44c2, 0xa2, 0x3c, 0x23, 0x8f, 0x2a, 0x3d, 0xf9, 0x28);
+            break;
+        default:
+            e.typeGuid = gptLinuxData;
+        }
+
+        return;
+    }
+
+    switch (t) {
+    case FileSystem::Extended:
+        e.systemId = 0x0f;
+        break;
+    case FileSystem::LinuxSwap:
+        e.systemId = 0x82;
+        break;
+    case FileSystem::Fat16:
+        e.systemId = 0x0e;
+        break;
+    case FileSystem::Fat32:
+        e.systemId = 0x0c;
+        break;
+    case FileSystem::Ntfs:
+    case FileSystem::Exfat:
+    case FileSystem::Hpfs:
+        e.systemId = 0x07;
+        break;
+    case FileSystem::Hfs:
+    case FileSystem::HfsPlus:
+        e.systemId = 0xaf;
+        break;
+    case FileSystem::Ufs:
+        e.systemId = 0xa8;
+        break;
+    case FileSystem::Lvm2_PV:
+        e.systemId = 0x8e;
+        break;
+    default:
+        e.systemId = 0x83;
+    }
+}
@@ -0,0 +1,134 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#if !defined(NATIVEDISKLABEL__H)
+
+#define NATIVEDISKLABEL__H
+
+#include "core/partitiontable.h"
+
+#include "fs/filesystem.h"
+
+#include <QList>
+#include <QString>
+#include <QUuid>
+#include <QtGlobal>
+
+class CoreBackendDevice;
+
+/** In-memory copy of an MBR or GPT partition table.
+
+    The label is read from an open file descriptor with plain pread() calls and written
+    to an exclusively opened CoreBackendDevice as a list of segments. The MBR, the GPT
+    header and the default GPT entry array are fetched in a single read. GPT writes put
+    the primary header and entries on disk and sync them before the backup entries and
+    header go out together, so an interrupted write always leaves one consistent copy
+    behind.
+
+    @author Andrius Štikonas <andrius@stikonas.eu>
+*/
+class NativeDiskLabel
+{
+public:
+    /** A single slot in the partition table. */
+    struct Entry {
+        Entry() : number(-1), firstSector(0), lastSector(0), role(PartitionRole::None), systemId(0), bootable(false), attributes(0) {}
+
+        qint32 number; /**< the number the kernel knows the partition under, e.g. 5 for /dev/sda5 */
+        qint64 firstSector;
+        qint64 lastSector;
+        PartitionRole::Roles role;
+        quint8 systemId; /**< MBR system id */
+        bool bootable; /**< MBR active flag */
+        QUuid typeGuid; /**< GPT partition type */
+        QUuid uniqueGuid; /**< GPT unique partition GUID */
+        quint64 attributes; /**< GPT attribute bits */
+        QString name; /**< GPT partition name */
+    };
+
+public:
+    NativeDiskLabel();
+
+public:
+    bool read(int fd);
+    bool write(CoreBackendDevice& device) const;
+    void reset(PartitionTable::TableType type);
+
+    PartitionTable::TableType type() const {
+        return m_Type;    /**< @return msdos, gpt or unknownTableType if no supported table was found */
+    }
+    qint32 sectorSize() const {
+        return m_SectorSize;    /**< @return the logical sector size in bytes */
+    }
+    qint64 totalSectors() const {
+        return m_TotalSectors;    /**< @return the device size in logical sectors */
+    }
+    qint64 firstUsable() const {
+        return m_FirstUsable;    /**< @return first sector a partition may start at */
+    }
+    qint64 lastUsable() const {
+        return m_LastUsable;    /**< @return last sector a partition may end at */
+    }
+    qint32 maxPrimaries() const;
+
+    QList<Entry>& entries() {
+        return m_Entries;    /**< @return the partitions, primaries and extended first */
+    }
+    const QList<Entry>& entries() const {
+        return m_Entries;    /**< @return the partitions, primaries and extended first */
+    }
+
+    Entry* findBySector(qint64 sector, bool extended = false);
+    const Entry* findByNumber(qint32 number) const;
+    Entry* extended();
+
+    bool fits(qint64 firstSector, qint64 lastSector, PartitionRole::Roles role, const Entry* ignore = nullptr) const;
+    qint32 add(const Entry& e);
+    bool remove(qint64 firstSector, bool extended);
+    bool setGeometry(Entry& e, qint64 firstSector, qint64 lastSector);
+
+    PartitionTable::Flags availableFlags(const Entry& e) const;
+    PartitionTable::Flags activeFlags(const Entry& e) const;
+    bool setFlag(Entry& e, PartitionTable::Flag flag, bool state);
+    void setSystemType(Entry& e, FileSystem::Type t) const;
+
+    static bool probe(int fd, qint32& sectorSize, qint64& totalSectors);
+    static quint32 crc32(const void* data, qint64 length, quint32 crc = 0);
+
+private:
+    bool readMsdos(int fd, const QByteArray& mbr);
+    bool readGpt(int fd, const QByteArray& head);
+    bool readGptHeader(int fd, const uchar* header, qint64 lba, const QByteArray& preloaded);
+    bool writeMsdos(CoreBackendDevice& device) const;
+    bool writeGpt(CoreBackendDevice& device) const;
+    void sortEntries();
+    void renumberLogicals();
+
+private:
+    PartitionTable::TableType m_Type;
+    qint32 m_SectorSize;
+    qint64 m_TotalSectors;
+    qint64 m_FirstUsable;
+    qint64 m_LastUsable;
+    QUuid m_DiskGuid;
+    quint32 m_DiskSignature;
+    quint32 m_GptEntryCount;
+    QByteArray m_BootCode;
+    QList<Entry> m_Entries;
+};
+
+#endif
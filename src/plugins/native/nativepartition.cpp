@@ -0,0 +1,50 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#include "plugins/native/nativepartition.h"
+#include "plugins/native/nativepartitiontable.h"
+
+#include "util/report.h"
+
+#include <KLocalizedString>
+
+NativePartition::NativePartition(NativePartitionTable& table, qint64 firstSector, bool extended) :
+    CoreBackendPartition(),
+    m_Table(table),
+    m_FirstSector(firstSector),
+    m_Extended(extended)
+{
+}
+
+bool NativePartition::setFlag(Report& report, PartitionTable::Flag flag, bool state)
+{
+    NativeDiskLabel& label = m_Table.label();
+    NativeDiskLabel::Entry* e = label.findBySector(m_FirstSector, m_Extended);
+
+    Q_ASSERT(e != nullptr);
+
+    if (e == nullptr)
+        return false;
+
+    // ignore flags that don't exist for this partition
+    if (!(label.availableFlags(*e) & flag)) {
+        report.line() << xi18nc("@info:progress", "The flag \"%1\" is not available on the partition's partition table.", PartitionTable::flagName(flag));
+        return true;
+    }
+
+    return label.setFlag(*e, flag, state);
+}
@@ -0,0 +1,46 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#if !defined(NATIVEPARTITION__H)
+
+#define NATIVEPARTITION__H
+
+#include "backend/corebackendpartition.h"
+
+#include "core/partitiontable.h"
+
+class NativePartitionTable;
+class Report;
+
+/** A partition in a NativePartitionTable, identified by its first sector.
+    @author Andrius Štikonas <andrius@stikonas.eu>
+*/
+class NativePartition : public CoreBackendPartition
+{
+public:
+    NativePartition(NativePartitionTable& table, qint64 firstSector, bool extended);
+
+public:
+    bool setFlag(Report& report, PartitionTable::Flag flag, bool state) override;
+
+private:
+    NativePartitionTable& m_Table;
+    qint64 m_FirstSector;
+    bool m_Extended;
+};
+
+#endif
@@ -0,0 +1,375 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#include "plugins/native/nativepartitiontable.h"
+#include "plugins/native/nativedevice.h"
+#include "plugins/native/nativepartition.h"
+
+#include "backend/corebackend.h"
+#include "backend/corebackendmanager.h"
+
+#include "core/partition.h"
+#include "core/device.h"
+
+#include "fs/filesystem.h"
+
+#include "util/globallog.h"
+#include "util/report.h"
+#include "util/ueventmonitor.h"
+
+#include <QVector>
+
+#include <KLocalizedString>
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/blkpg.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** Add, remove or resize a single partition in the kernel's view of a device.
+    @param fd the whole device
+    @param op one of BLKPG_ADD_PARTITION, BLKPG_DEL_PARTITION or BLKPG_RESIZE_PARTITION
+    @param e the partition
+    @param sectorSize the device's logical sector size
+    @return true on success
+*/
+static bool blkpg(int fd, int op, const NativeDiskLabel::Entry& e, qint32 sectorSize)
+{
+    struct blkpg_partition part;
+    memset(&part, 0, sizeof(part));
+    part.pno = e.number;
+    part.start = e.firstSector * sectorSize;
+    part.length = (e.lastSector - e.firstSector + 1) * sectorSize;
+
+    // the kernel only maps the boot record of an extended partition, but still wants whole sectors
+    if (e.role.testFlag(PartitionRole::Extended))
+        part.length = qMin(part.length, qMax<long long>(1024, sectorSize));
+
+    struct blkpg_ioctl_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.op = op;
+    arg.datalen = sizeof(part);
+    arg.data = &part;
+
+    return ioctl(fd, BLKPG, &arg) == 0;
+}
+
+NativePartitionTable::NativePartitionTable(const QString& deviceNode) :
+    CoreBackendPartitionTable(),
+    m_DeviceNode(deviceNode)
+{
+}
+
+NativePartitionTable::~NativePartitionTable()
+{
+}
+
+/** Read the table from disk, whether or not the device has a supported one.
+    @return true if the device could be read
+*/
+bool NativePartitionTable::read()
+{
+    const int fd = ::open(deviceNode().toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1)
+        return false;
+
+    const bool rval = m_Label.read(fd);
+    ::close(fd);
+
+    m_Original = m_Label;
+
+    return rval;
+}
+
+bool NativePartitionTable::open()
+{
+    return read() && m_Label.type() != PartitionTable::unknownTableType;
+}
+
+bool NativePartitionTable::commit(quint32 timeout)
+{
+    NativeDevice device(deviceNode());
+
+    if (!device.openExclusive())
+        return false;
+
+    QMap<qint32, qint64> starts;
+    for (const auto &e : m_Label.entries())
+        starts[e.number] = e.firstSector * m_Label.sectorSize();
+
+    // subscribe before committing so that no event gets lost
+    UeventMonitor monitor;
+    monitor.expectPartitions(deviceNode(), starts);
+
+    bool rval = m_Label.write(device);
+
+    if (rval)
+        rval = updateKernel(device.fd());
+
+    device.close();
+
+    if (!monitor.wait(timeout))
+        Log(Log::warning) << xi18nc("@info:status", "Timed out waiting for device nodes: <filename>%1</filename>", monitor.lateNodes().join(QStringLiteral(", ")));
+
+    if (rval)
+        m_Original = m_Label;
+
+    return rval;
+}
+
+/** Tell the kernel about the partitions that differ between the table as it was read
+    and as it was just written. Partitions that did not change are not touched, so they
+    may stay mounted.
+    @param fd the whole device
+    @return true if the kernel accepted all changes
+*/
+bool NativePartitionTable::updateKernel(int fd) const
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISBLK(st.st_mode))
+        return true;
+
+    const qint32 sectorSize = m_Label.sectorSize();
+    QList<qint32> current;
+    QList<NativeDiskLabel::Entry> shrunk;
+    QList<NativeDiskLabel::Entry> grown;
+    QList<NativeDiskLabel::Entry> removed;
+    bool rval = true;
+
+    for (const auto &old : m_Original.entries()) {
+        const NativeDiskLabel::Entry* now = m_Label.findByNumber(old.number);
+
+        if (now && now->firstSector == old.firstSector && now->role == old.role) {
+            current.append(old.number);
+
+            if (now->lastSector < old.lastSector)
+                shrunk.append(*now);
+            else if (now->lastSector > old.lastSector)
+                grown.append(*now);
+        } else
+            removed.append(old);
+    }
+
+    // take away what is gone first, then shrink, then grow, so that no step overlaps a
+    // partition the kernel still knows about; a failed resize falls back to removing and
+    // adding the partition again
+    for (const auto &old : removed) {
+        if (!blkpg(fd, BLKPG_DEL_PARTITION, old, sectorSize)) {
+            Log(Log::warning) << xi18nc("@info:status", "Could not remove partition <filename>%1</filename> from the kernel's partition table.", partitionNode(deviceNode(), old.number));
+            rval = false;
+        }
+    }
+
+    for (const auto &now : shrunk + grown) {
+        if (blkpg(fd, BLKPG_RESIZE_PARTITION, now, sectorSize))
+            continue;
+
+        current.removeAll(now.number);
+
+        const NativeDiskLabel::Entry* old = m_Original.findByNumber(now.number);
+        if (!blkpg(fd, BLKPG_DEL_PARTITION, *old, sectorSize)) {
+            Log(Log::warning) << xi18nc("@info:status", "Could not remove partition <filename>%1</filename> from the kernel's partition table.", partitionNode(deviceNode(), old->number));
+            rval = false;
+        }
+    }
+
+    for (const auto &now : m_Label.entries()) {
+        if (current.contains(now.number))
+            continue;
+
+        if (!blkpg(fd, BLKPG_ADD_PARTITION, now, sectorSize)) {
+            Log(Log::warning) << xi18nc("@info:status", "Could not add partition <filename>%1</filename> to the kernel's partition table.", partitionNode(deviceNode(), now.number));
+            rval = false;
+        }
+    }
+
+    return rval;
+}
+
+/** @return the device node for a partition number, e.g. /dev/sda3 or /dev/nvme0n1p3 */
+QString NativePartitionTable::partitionNode(const QString& deviceNode, qint32 number)
+{
+    if (!deviceNode.isEmpty() && deviceNode.at(deviceNode.size() - 1).isDigit())
+        return deviceNode + QStringLiteral("p") + QString::number(number);
+
+    return deviceNode + QString::number(number);
+}
+
+CoreBackendPartition* NativePartitionTable::getExtendedPartition()
+{
+    NativeDiskLabel::Entry* e = m_Label.extended();
+
+    if (e == nullptr)
+        return nullptr;
+
+    return new NativePartition(*this, e->firstSector, true);
+}
+
+CoreBackendPartition* NativePartitionTable::getPartitionBySector(qint64 sector)
+{
+    NativeDiskLabel::Entry* e = m_Label.findBySector(sector);
+
+    if (e == nullptr)
+        return nullptr;
+
+    return new NativePartition(*this, e->firstSector, e->role.testFlag(PartitionRole::Extended));
+}
+
+QString NativePartitionTable::createPartition(Report& report, const Partition& partition)
+{
+    Q_ASSERT(partition.devicePath() == deviceNode());
+
+    NativeDiskLabel::Entry e;
+
+    if (partition.roles().has(PartitionRole::Extended))
+        e.role = PartitionRole::Extended;
+    else if (partition.roles().has(PartitionRole::Logical))
+        e.role = PartitionRole::Logical;
+    else if (partition.roles().has(PartitionRole::Primary))
+        e.role = PartitionRole::Primary;
+    else {
+        report.line() << xi18nc("@info:progress", "Unknown partition role for new partition <filename>%1</filename> (roles: %2)", partition.deviceNode(), partition.roles().toString());
+        return QString();
+    }
+
+    if (e.role != PartitionRole::Primary && m_Label.type() != PartitionTable::msdos) {
+        report.line() << xi18nc("@info:progress", "Failed to create new partition <filename>%1</filename>.", partition.deviceNode());
+        return QString();
+    }
+
+    e.firstSector = partition.firstSector();
+    e.lastSector = partition.lastSector();
+    m_Label.setSystemType(e, e.role == PartitionRole::Extended ? FileSystem::Extended : partition.fileSystem().type());
+
+    const qint32 number = m_Label.add(e);
+
+    if (number < 0) {
+        report.line() << xi18nc("@info:progress", "Failed to add partition <filename>%1</filename> to device <filename>%2</filename>.", partition.deviceNode(), deviceNode());
+        return QString();
+    }
+
+    return partitionNode(deviceNode(), number);
+}
+
+bool NativePartitionTable::deletePartition(Report& report, const Partition& partition)
+{
+    Q_ASSERT(partition.devicePath() == deviceNode());
+
+    if (!m_Label.remove(partition.firstSector(), partition.roles().has(PartitionRole::Extended))) {
+        report.line() << xi18nc("@info:progress", "Deleting partition failed: Partition to delete (<filename>%1</filename>) not found on disk.", partition.deviceNode());
+        return false;
+    }
+
+    return true;
+}
+
+bool NativePartitionTable::updateGeometry(Report& report, const Partition& partition, qint64 sector_start, qint64 sector_end)
+{
+    Q_ASSERT(partition.devicePath() == deviceNode());
+
+    NativeDiskLabel::Entry* e = m_Label.findBySector(partition.firstSector(), partition.roles().has(PartitionRole::Extended));
+
+    if (e == nullptr) {
+        report.line() << xi18nc("@info:progress", "Could not open partition <filename>%1</filename> while trying to resize/move it.", partition.deviceNode());
+        return false;
+    }
+
+    if (!m_Label.setGeometry(*e, sector_start, sector_end)) {
+        report.line() << xi18nc("@info:progress", "Could not set geometry for partition <filename>%1</filename> while trying to resize/move it.", partition.deviceNode());
+        return false;
+    }
+
+    return true;
+}
+
+bool NativePartitionTable::clobberFileSystem(Report& report, const Partition& partition)
+{
+    NativeDiskLabel::Entry* e = m_Label.findBySector(partition.firstSector());
+
+    if (e == nullptr) {
+        report.line() << xi18nc("@info:progress", "Could not delete file system on partition <filename>%1</filename>: Failed to get partition.", partition.deviceNode());
+        return false;
+    }
+
+    if (e->role.testFlag(PartitionRole::Extended))
+        return true;
+
+    // reiser4 stores "ReIsEr4" at sector 128 with a sector size of 512 bytes; RAID
+    // superblocks and ZFS labels live in the last 128 KiB of the partition
+    const qint64 sectors = e->lastSector - e->firstSector + 1;
+    const qint64 head = qMin<qint64>(129, sectors);
+    const qint64 tail = qMin<qint64>(128 * 1024 / m_Label.sectorSize(), sectors - head);
+    QByteArray zeroes(qMax(head, tail) * m_Label.sectorSize(), 0);
+
+    QVector<CoreBackendDevice::Segment> segments = { { zeroes.data(), e->firstSector, head } };
+    if (tail > 0)
+        segments.append({ zeroes.data(), e->lastSector - tail + 1, tail });
+
+    NativeDevice device(deviceNode());
+    const bool rval = device.openExclusive() && device.writeSegments(segments) && device.sync();
+
+    if (!rval)
+        report.line() << xi18nc("@info:progress", "Failed to erase filesystem signature on partition <filename>%1</filename>.", partition.deviceNode());
+
+    return rval;
+}
+
+bool NativePartitionTable::resizeFileSystem(Report& report, const Partition& partition, qint64 newLength)
+{
+    Q_UNUSED(report);
+    Q_UNUSED(partition);
+    Q_UNUSED(newLength);
+
+    return false;
+}
+
+FileSystem::Type NativePartitionTable::detectFileSystemBySector(Report& report, const Device& device, qint64 sector)
+{
+    const NativeDiskLabel::Entry* e = m_Label.findBySector(sector);
+
+    if (e == nullptr || e->role.testFlag(PartitionRole::Extended)) {
+        report.line() << xi18nc("@info:progress", "Could not determine file system of partition at sector %1 on device <filename>%2</filename>.", sector, device.deviceNode());
+        return FileSystem::Unknown;
+    }
+
+    return CoreBackendManager::self()->backend()->detectFileSystem(partitionNode(deviceNode(), e->number));
+}
+
+bool NativePartitionTable::setPartitionSystemType(Report& report, const Partition& partition)
+{
+    if (partition.roles().has(PartitionRole::Extended) || partition.fileSystem().type() == FileSystem::Unformatted) {
+        report.line() << xi18nc("@info:progress", "Could not update the system type for partition <filename>%1</filename>.", partition.deviceNode());
+        report.line() << xi18nc("@info:progress", "No file system defined.");
+        return false;
+    }
+
+    NativeDiskLabel::Entry* e = m_Label.findBySector(partition.firstSector());
+
+    if (e == nullptr) {
+        report.line() << xi18nc("@info:progress", "Could not update the system type for partition <filename>%1</filename>.", partition.deviceNode());
+        report.line() << xi18nc("@info:progress", "No partition found at sector %1.", partition.firstSector());
+        return false;
+    }
+
+    m_Label.setSystemType(*e, partition.fileSystem().type());
+
+    return true;
+}
@@ -0,0 +1,83 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#if !defined(NATIVEPARTITIONTABLE__H)
+
+#define NATIVEPARTITIONTABLE__H
+
+#include "backend/corebackendpartitiontable.h"
+
+#include "plugins/native/nativedisklabel.h"
+
+#include "fs/filesystem.h"
+
+#include <QtGlobal>
+
+class CoreBackendPartition;
+class Report;
+class Partition;
+
+/** A partition table edited in memory and written out on commit().
+
+    Changes only touch the in-memory NativeDiskLabel. commit() writes the whole table
+    and then tells the kernel about each partition that was added, removed or moved
+    with the BLKPG ioctl, leaving all other partitions of the device alone.
+
+    @author Andrius Štikonas <andrius@stikonas.eu>
+*/
+class NativePartitionTable : public CoreBackendPartitionTable
+{
+public:
+    NativePartitionTable(const QString& deviceNode);
+    ~NativePartitionTable();
+
+public:
+    bool open() override;
+    bool read();
+
+    bool commit(quint32 timeout = 10) override;
+
+    CoreBackendPartition* getExtendedPartition() override;
+    CoreBackendPartition* getPartitionBySector(qint64 sector) override;
+
+    QString createPartition(Report& report, const Partition& partition) override;
+    bool deletePartition(Report& report, const Partition& partition) override;
+    bool updateGeometry(Report& report, const Partition& partition, qint64 sector_start, qint64 sector_end) override;
+    bool clobberFileSystem(Report& report, const Partition& partition) override;
+    bool resizeFileSystem(Report& report, const Partition& partition, qint64 newLength) override;
+    FileSystem::Type detectFileSystemBySector(Report& report, const Device& device, qint64 sector) override;
+    bool setPartitionSystemType(Report& report, const Partition& partition) override;
+
+    NativeDiskLabel& label() {
+        return m_Label;    /**< @return the table as it will be written on commit */
+    }
+    const QString& deviceNode() const {
+        return m_DeviceNode;    /**< @return the device node, e.g. /dev/sda */
+    }
+
+    static QString partitionNode(const QString& deviceNode, qint32 number);
+
+private:
+    bool updateKernel(int fd) const;
+
+private:
+    const QString m_DeviceNode;
+    NativeDiskLabel m_Original;
+    NativeDiskLabel m_Label;
+};
+
+#endif
@@ -18,15 +18,22 @@
 
 #include "util/externalcommand.h"
 
+#include "util/lvmcommandsession.h"
 #include "util/report.h"
 
 #include <cstdlib>
 
+#include <QFile>
+#include <QMutexLocker>
 #include <QString>
 #include <QStringList>
 
 #include <KLocalizedString>
 
+QHash<QString, ExternalCommand::CachedResult> ExternalCommand::s_Cache;
+QMutex ExternalCommand::s_CacheMutex;
+int ExternalCommand::s_CachedScans = 0;
+
 /** Creates a new ExternalCommand instance without Report.
     @param cmd the command to run
     @param args the arguments to pass to the command
@@ -37,7 +44,14 @@ ExternalCommand::ExternalCommand(const QString& cmd, const QStringList& args) :
     m_Command(cmd),
     m_Args(args),
     m_ExitCode(-1),
-    m_Output()
+    m_Output(),
+    m_LineHandler(),
+    m_ProgressDecoder(),
+    m_PartialLine(),
+    m_OutputLimit(-1),
+    m_OutputChars(0),
+    m_ReportedChars(0),
+    m_SpillFileName()
 {
     setup();
 }
@@ -53,7 +67,14 @@ ExternalCommand::ExternalCommand(Report& report, const QString& cmd, const QStri
     m_Command(cmd),
     m_Args(args),
     m_ExitCode(-1),
-    m_Output()
+    m_Output(),
+    m_LineHandler(),
+    m_ProgressDecoder(),
+    m_PartialLine(),
+    m_OutputLimit(-1),
+    m_OutputChars(0),
+    m_ReportedChars(0),
+    m_SpillFileName()
 {
     setup();
 }
@@ -67,17 +88,23 @@ void ExternalCommand::setup()
     connect(this, &ExternalCommand::readyReadStandardOutput, this, &ExternalCommand::onReadOutput);
 }
 
-/** Starts the external command.
-    @param timeout timeout to wait for the process to start
-    @return true on success
-*/
-bool ExternalCommand::start(int timeout)
+/** Starts the external command without waiting for it to start. */
+void ExternalCommand::launch()
 {
     QProcess::start(command(), args());
 
     if (report()) {
         report()->setCommand(xi18nc("@info:status", "Command: %1 %2", command(), args().join(QStringLiteral(" "))));
     }
+}
+
+/** Starts the external command.
+    @param timeout timeout to wait for the process to start
+    @return true on success
+*/
+bool ExternalCommand::start(int timeout)
+{
+    launch();
 
     if (!waitForStarted(timeout))
     {
@@ -104,30 +131,264 @@ bool ExternalCommand::waitFor(int timeout)
     }
 
     onReadOutput();
+    finishOutput();
     return true;
 }
 
 /** Runs the command.
+
+    LVM commands are passed to the current LvmCommandSession if there is one. During a
+    cached scan, read-only queries are answered from the cache if they have run before.
+
     @param timeout timeout to use for waiting when starting and when waiting for the process to finish
     @return true on success
 */
 bool ExternalCommand::run(int timeout)
 {
-    return start(timeout) && waitFor(timeout) && exitStatus() == 0;
+    const bool cacheable = isCacheable();
+
+    if (cacheable) {
+        QMutexLocker locker(&s_CacheMutex);
+        if (s_CachedScans > 0 && s_Cache.contains(cacheKey())) {
+            const CachedResult result = s_Cache.value(cacheKey());
+            locker.unlock();
+
+            setExitCode(result.exitCode);
+            appendOutput(result.output);
+            finishOutput();
+            return result.success;
+        }
+    } else if (isMutating())
+        invalidateCache();
+
+    bool rval;
+    LvmCommandSession* session = LvmCommandSession::current();
+    if (session && session->accepts(*this))
+        rval = session->exec(*this, timeout);
+    else
+        rval = start(timeout) && waitFor(timeout) && exitStatus() == 0;
+
+    if (cacheable && rval) {
+        QMutexLocker locker(&s_CacheMutex);
+        if (s_CachedScans > 0)
+            s_Cache.insert(cacheKey(), CachedResult{ rval, exitCode(), output() });
+    }
+
+    return rval;
 }
 
-void ExternalCommand::onReadOutput()
+/** Starts caching the results of read-only commands, see CachedScan.
+
+    Calls can be nested. The cache starts out empty and is cleared again by the matching
+    endCachedScan(), so no result outlives the scan it was collected in.
+*/
+void ExternalCommand::beginCachedScan()
 {
-    const QString s = QString::fromUtf8(readAllStandardOutput());
+    QMutexLocker locker(&s_CacheMutex);
+    if (s_CachedScans++ == 0)
+        s_Cache.clear();
+}
 
-    m_Output += s;
+/** Stops caching started by beginCachedScan(). */
+void ExternalCommand::endCachedScan()
+{
+    QMutexLocker locker(&s_CacheMutex);
+    if (--s_CachedScans == 0)
+        s_Cache.clear();
+}
+
+/** Throws away all cached command results. */
+void ExternalCommand::invalidateCache()
+{
+    QMutexLocker locker(&s_CacheMutex);
+    s_Cache.clear();
+}
+
+/** @return true if this is a read-only query whose result can be reused within a scan
+
+    Only commands without a Report are cached, since the Report has to show the real run.
+*/
+bool ExternalCommand::isCacheable() const
+{
+    if (m_Report != nullptr || m_LineHandler || m_ProgressDecoder || args().isEmpty())
+        return false;
+
+    if (command() == QStringLiteral("lsblk") || command() == QStringLiteral("blkid"))
+        return true;
+
+    static const QStringList lvmQueries = { QStringLiteral("pvs"), QStringLiteral("vgs"), QStringLiteral("lvs"),
+                                            QStringLiteral("pvdisplay"), QStringLiteral("vgdisplay"), QStringLiteral("lvdisplay") };
+    if (command() == QStringLiteral("lvm"))
+        return lvmQueries.contains(args().first());
+
+    static const QStringList cryptsetupQueries = { QStringLiteral("luksDump"), QStringLiteral("status"), QStringLiteral("isLuks") };
+    if (command() == QStringLiteral("cryptsetup"))
+        return cryptsetupQueries.contains(args().first());
 
-    if (report())
-        *report() << s;
+    return false;
+}
+
+/** @return true if this command may change what the cached queries return
+
+    Jobs pass a Report to every command that changes anything. LVM, cryptsetup and
+    dmsetup commands other than the known queries are assumed to change state as well.
+*/
+bool ExternalCommand::isMutating() const
+{
+    if (m_Report != nullptr)
+        return true;
+
+    return command() == QStringLiteral("lvm") || command() == QStringLiteral("cryptsetup") || command() == QStringLiteral("dmsetup");
+}
+
+QString ExternalCommand::cacheKey() const
+{
+    return command() + QLatin1Char('\0') + args().join(QLatin1Char('\0'));
+}
+
+void ExternalCommand::onReadOutput()
+{
+    appendOutput(QString::fromUtf8(readAllStandardOutput()));
 }
 
 void ExternalCommand::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
     Q_UNUSED(exitStatus)
     setExitCode(exitCode);
+    finishOutput();
+}
+
+/** Processes a chunk of output.
+
+    Without a line handler or progress decoder the chunk is stored right away. Otherwise it is
+    split into lines at newlines and carriage returns (the latter are used by tools that redraw
+    a progress line) and each line is processed on its own.
+
+    @param s the output that has just been read
+*/
+void ExternalCommand::appendOutput(const QString& s)
+{
+    // a single line is never buffered beyond this, even if it has no newline yet
+    const int maxLineLength = 64 * 1024;
+
+    if (s.isEmpty())
+        return;
+
+    if (!m_LineHandler && !m_ProgressDecoder) {
+        storeOutput(s);
+        return;
+    }
+
+    m_PartialLine += s;
+
+    int start = 0;
+    for (int i = 0; i < m_PartialLine.size(); i++) {
+        const QChar c = m_PartialLine.at(i);
+        if (c != QLatin1Char('\n') && c != QLatin1Char('\r'))
+            continue;
+
+        if (c == QLatin1Char('\n') && start == i && i > 0 && m_PartialLine.at(i - 1) == QLatin1Char('\r'))
+            storeOutput(QStringLiteral("\n")); // second half of a CRLF
+        else
+            processLine(m_PartialLine.mid(start, i - start), c);
+
+        start = i + 1;
+    }
+    m_PartialLine.remove(0, start);
+
+    if (m_PartialLine.size() > maxLineLength) {
+        processLine(m_PartialLine, QChar());
+        m_PartialLine.clear();
+    }
+}
+
+/** Processes a single line of output.
+
+    Lines the progress decoder recognizes are turned into a progress update on the Report and
+    are not stored. All other lines are stored and passed to the line handler.
+
+    @param line the line without its terminator
+    @param terminator the character that ended the line, a null QChar if there was none
+*/
+void ExternalCommand::processLine(const QString& line, QChar terminator)
+{
+    if (m_ProgressDecoder) {
+        const int percent = m_ProgressDecoder(line);
+        if (percent >= 0) {
+            if (report())
+                report()->setProgress(qMin(percent, 100));
+            return;
+        }
+    }
+
+    storeOutput(terminator.isNull() ? line : line + terminator);
+
+    if (m_LineHandler)
+        m_LineHandler(line);
+}
+
+/** Stores output in output(), the Report and the spill file.
+
+    With an output limit, output() only keeps the last outputLimit() characters and the Report
+    only gets the first outputLimit() characters until the command has finished.
+
+    @param s the output to store
+*/
+void ExternalCommand::storeOutput(const QString& s)
+{
+    m_OutputChars += s.size();
+
+    if (!spillFileName().isEmpty()) {
+        QFile spillFile(spillFileName());
+        if (spillFile.open(QIODevice::WriteOnly | QIODevice::Append))
+            spillFile.write(s.toUtf8());
+    }
+
+    m_Output += s;
+
+    if (outputLimit() < 0) {
+        if (report())
+            *report() << s;
+    } else {
+        if (m_Output.size() > outputLimit())
+            m_Output.remove(0, m_Output.size() - outputLimit());
+
+        if (report() && m_ReportedChars < outputLimit()) {
+            const QString head = s.left(outputLimit() - m_ReportedChars);
+            *report() << head;
+            m_ReportedChars += head.size();
+        }
+    }
+}
+
+/** Passes on what is left of the output once the command has finished.
+
+    Processes an unterminated last line and, if the output limit cut something
+    out of the Report, appends a note and the tail of the output to it.
+*/
+void ExternalCommand::finishOutput()
+{
+    if (!m_PartialLine.isEmpty()) {
+        processLine(m_PartialLine, QChar());
+        m_PartialLine.clear();
+    }
+
+    if (outputLimit() < 0 || m_ReportedChars >= m_OutputChars)
+        return;
+
+    if (report()) {
+        const qint64 tail = qMin(static_cast<qint64>(m_Output.size()), m_OutputChars - m_ReportedChars);
+        const qint64 omitted = m_OutputChars - m_ReportedChars - tail;
+
+        if (omitted > 0) {
+            if (spillFileName().isEmpty())
+                report()->line() << xi18nc("@info:status", "(%1 characters of output omitted)", omitted);
+            else
+                report()->line() << xi18nc("@info:status", "(%1 characters of output omitted, see <filename>%2</filename>)", omitted, spillFileName());
+        }
+
+        *report() << m_Output.right(tail);
+    }
+
+    m_ReportedChars = m_OutputChars;
 }
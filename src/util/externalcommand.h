@@ -21,8 +21,11 @@
 
 #include "util/libpartitionmanagerexport.h"
 
+#include <functional>
 #include <vector>
 
+#include <QHash>
+#include <QMutex>
 #include <QProcess>
 #include <QStringList>
 #include <QString>
@@ -41,6 +44,30 @@ class LIBKPMCORE_EXPORT ExternalCommand : public QProcess
 {
     Q_DISABLE_COPY(ExternalCommand)
 
+    friend class LvmCommandSession;
+    friend class ExternalCommandQueue;
+
+public:
+    typedef std::function<void(const QString&)> LineHandler;
+    typedef std::function<int(const QString&)> ProgressDecoder;
+
+    /** Caches the results of read-only commands for as long as it exists, e.g. for the
+        duration of a device scan. Guards can be nested; the cache starts out empty and is
+        cleared again when the outermost one goes away.
+    */
+    class CachedScan
+    {
+        Q_DISABLE_COPY(CachedScan)
+
+    public:
+        CachedScan() {
+            beginCachedScan();
+        }
+        ~CachedScan() {
+            endCachedScan();
+        }
+    };
+
 public:
     explicit ExternalCommand(const QString& cmd = QString(), const QStringList& args = QStringList());
     explicit ExternalCommand(Report& report, const QString& cmd = QString(), const QStringList& args = QStringList());
@@ -69,21 +96,76 @@ public:
         return m_Report;    /**< @return pointer to the Report or nullptr */
     }
 
+    static void invalidateCache();
+
+    void setLineHandler(const LineHandler& handler) {
+        m_LineHandler = handler;    /**< @param handler called with each line of output (without the newline) as soon as it has been read */
+    }
+
+    void setProgressDecoder(const ProgressDecoder& decoder) {
+        m_ProgressDecoder = decoder;    /**< @param decoder returns the percentage for a progress line of output, -1 for other lines */
+    }
+
+    qint32 outputLimit() const {
+        return m_OutputLimit;    /**< @return the maximum number of characters of output kept, -1 if unlimited */
+    }
+    void setOutputLimit(qint32 limit) {
+        m_OutputLimit = limit;    /**< @param limit the maximum number of characters of output kept in output() and the Report, -1 for no limit */
+    }
+
+    const QString& spillFileName() const {
+        return m_SpillFileName;    /**< @return name of the file the complete output is written to, empty if none */
+    }
+    void setSpillFileName(const QString& name) {
+        m_SpillFileName = name;    /**< @param name name of a file to append the complete output to */
+    }
+
 protected:
     void setExitCode(int i) {
         m_ExitCode = i;
     }
     void setup();
+    void launch();
+
+    bool isCacheable() const;
+    bool isMutating() const;
+    QString cacheKey() const;
+
+    static void beginCachedScan();
+    static void endCachedScan();
 
     void onFinished(int exitCode, QProcess::ExitStatus exitStatus);
     void onReadOutput();
 
+    void appendOutput(const QString& s);
+    void processLine(const QString& line, QChar terminator);
+    void storeOutput(const QString& s);
+    void finishOutput();
+
 private:
     Report *m_Report;
     QString m_Command;
     QStringList m_Args;
     int m_ExitCode;
     QString m_Output;
+    LineHandler m_LineHandler;
+    ProgressDecoder m_ProgressDecoder;
+    QString m_PartialLine;
+    qint32 m_OutputLimit;
+    qint64 m_OutputChars;
+    qint64 m_ReportedChars;
+    QString m_SpillFileName;
+
+    struct CachedResult
+    {
+        bool success;
+        int exitCode;
+        QString output;
+    };
+
+    static QHash<QString, CachedResult> s_Cache;
+    static QMutex s_CacheMutex;
+    static int s_CachedScans;
 };
 
 #endif
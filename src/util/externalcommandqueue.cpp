@@ -0,0 +1,137 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#include "util/externalcommandqueue.h"
+#include "util/externalcommand.h"
+
+#include <QEventLoop>
+#include <QThread>
+#include <QTimer>
+
+/** Creates a new ExternalCommandQueue.
+    @param maxParallel maximum number of commands running at the same time, 0 for the number of CPUs
+*/
+ExternalCommandQueue::ExternalCommandQueue(qint32 maxParallel) :
+    m_MaxParallel(maxParallel > 0 ? maxParallel : qMax(1, QThread::idealThreadCount())),
+    m_Running(0),
+    m_Failed(false),
+    m_Destroying(false),
+    m_Pending(),
+    m_Commands(),
+    m_Loop(nullptr)
+{
+}
+
+/** Destroys the queue and all commands in it. Commands still running are killed. */
+ExternalCommandQueue::~ExternalCommandQueue()
+{
+    m_Destroying = true;
+    m_Pending.clear();
+
+    for (const auto &cmd : m_Commands) {
+        if (cmd->state() != QProcess::NotRunning) {
+            cmd->kill();
+            cmd->waitForFinished(-1);
+        }
+    }
+
+    qDeleteAll(m_Commands);
+}
+
+/** Adds a command to the queue and starts it if fewer than maxParallel() commands are running.
+
+    The queue takes ownership of the command. It is deleted together with the queue, so
+    its output can still be read after waitForAll().
+
+    @param cmd the command to run
+    @param done called in the queue's thread once the command has finished or failed to start
+*/
+void ExternalCommandQueue::enqueue(ExternalCommand* cmd, const Continuation& done)
+{
+    Q_ASSERT(cmd);
+
+    m_Commands.append(cmd);
+    m_Pending.enqueue(Entry{ cmd, done });
+
+    startNext();
+}
+
+/** Runs the event loop until all commands have finished.
+    @param timeout time to wait in milliseconds, -1 to wait forever
+    @return true if all commands finished in time with exit code 0
+*/
+bool ExternalCommandQueue::waitForAll(int timeout)
+{
+    if (!isIdle()) {
+        QEventLoop loop;
+        QTimer timer;
+
+        if (timeout >= 0) {
+            timer.setSingleShot(true);
+            QObject::connect(&timer, &QTimer::timeout, &loop, &QEventLoop::quit);
+            timer.start(timeout);
+        }
+
+        m_Loop = &loop;
+        loop.exec(QEventLoop::ExcludeUserInputEvents);
+        m_Loop = nullptr;
+    }
+
+    return isIdle() && !m_Failed;
+}
+
+void ExternalCommandQueue::startNext()
+{
+    while (m_Running < maxParallel() && !m_Pending.isEmpty()) {
+        const Entry entry = m_Pending.dequeue();
+        ExternalCommand* cmd = entry.cmd;
+        const Continuation done = entry.done;
+
+        m_Running++;
+
+        QObject::connect(cmd, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), cmd,
+            [this, cmd, done](int, QProcess::ExitStatus exitStatus) {
+                onFinished(*cmd, exitStatus == QProcess::NormalExit && cmd->exitCode() == 0, done);
+            });
+        QObject::connect(cmd, &QProcess::errorOccurred, cmd,
+            [this, cmd, done](QProcess::ProcessError error) {
+                if (error == QProcess::FailedToStart)
+                    onFinished(*cmd, false, done);
+            });
+
+        cmd->launch();
+    }
+}
+
+void ExternalCommandQueue::onFinished(ExternalCommand& cmd, bool success, const Continuation& done)
+{
+    if (m_Destroying)
+        return;
+
+    m_Running--;
+
+    if (!success)
+        m_Failed = true;
+
+    if (done)
+        done(cmd);
+
+    startNext();
+
+    if (isIdle() && m_Loop)
+        m_Loop->quit();
+}
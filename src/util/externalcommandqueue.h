@@ -0,0 +1,86 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#if !defined(EXTERNALCOMMANDQUEUE__H)
+
+#define EXTERNALCOMMANDQUEUE__H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <functional>
+
+#include <QList>
+#include <QQueue>
+#include <QtGlobal>
+
+class ExternalCommand;
+
+class QEventLoop;
+
+/** Runs several external commands concurrently from one thread.
+
+    Commands are started without blocking and driven by the thread's event loop. At most
+    maxParallel() of them run at the same time, the rest wait in the queue. When a command
+    finishes, its continuation is called in the queue's thread and the next command is started.
+
+    This is meant for independent read-only probes like blkid, dumpe2fs or cryptsetup luksDump.
+    Commands run as plain processes, never through an LvmCommandSession.
+
+    @see ExternalCommand
+*/
+class LIBKPMCORE_EXPORT ExternalCommandQueue
+{
+    Q_DISABLE_COPY(ExternalCommandQueue)
+
+public:
+    typedef std::function<void(ExternalCommand&)> Continuation;
+
+    explicit ExternalCommandQueue(qint32 maxParallel = 0);
+    ~ExternalCommandQueue();
+
+public:
+    void enqueue(ExternalCommand* cmd, const Continuation& done = Continuation());
+    bool waitForAll(int timeout = -1);
+
+    qint32 maxParallel() const {
+        return m_MaxParallel;    /**< @return maximum number of commands running at the same time */
+    }
+    bool isIdle() const {
+        return m_Running == 0 && m_Pending.isEmpty();    /**< @return true if no command is running or waiting */
+    }
+
+protected:
+    void startNext();
+    void onFinished(ExternalCommand& cmd, bool success, const Continuation& done);
+
+private:
+    struct Entry
+    {
+        ExternalCommand* cmd;
+        Continuation done;
+    };
+
+    qint32 m_MaxParallel;
+    qint32 m_Running;
+    bool m_Failed;
+    bool m_Destroying;
+    QQueue<Entry> m_Pending;
+    QList<ExternalCommand*> m_Commands;
+    QEventLoop* m_Loop;
+};
+
+#endif
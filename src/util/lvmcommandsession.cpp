@@ -0,0 +1,260 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#include "util/lvmcommandsession.h"
+#include "util/externalcommand.h"
+#include "util/report.h"
+
+#include <QProcess>
+#include <QRegularExpression>
+#include <QString>
+
+#include <KLocalizedString>
+
+#include <cstdlib>
+
+thread_local LvmCommandSession* LvmCommandSession::s_Current = nullptr;
+
+/** Creates a new LvmCommandSession.
+
+    The first session created in a thread becomes the current session of that thread. The lvm
+    shell itself is started lazily when the first command is run.
+*/
+LvmCommandSession::LvmCommandSession() :
+    m_Process(nullptr),
+    m_Owner(s_Current == nullptr),
+    m_Failed(false),
+    m_NumCommands(0)
+{
+    if (m_Owner)
+        s_Current = this;
+}
+
+/** Destroys the session and quits the lvm shell if this is the outermost session. */
+LvmCommandSession::~LvmCommandSession()
+{
+    if (m_Owner) {
+        stop();
+        s_Current = nullptr;
+    }
+}
+
+/** @return the session LVM commands in the calling thread should use or nullptr if there is none */
+LvmCommandSession* LvmCommandSession::current()
+{
+    return s_Current;
+}
+
+/** @return the prompt the lvm shell prints when it is ready for the next command */
+const QByteArray& LvmCommandSession::prompt()
+{
+    static const QByteArray p("lvm> ");
+    return p;
+}
+
+/** @return true if the lvm shell is up and running */
+bool LvmCommandSession::isRunning() const
+{
+    return m_Process && m_Process->state() == QProcess::Running;
+}
+
+/** Checks if an ExternalCommand can be run through this session.
+
+    The lvm shell splits its input on white space and has no quoting, so commands with empty
+    arguments or arguments containing white space must run as separate processes. So must
+    commands with maxArguments arguments or more, which the shell refuses to run.
+
+    @param cmd the command to check
+    @return true if the command can be streamed to the lvm shell
+*/
+bool LvmCommandSession::accepts(const ExternalCommand& cmd)
+{
+    if (cmd.command() != QStringLiteral("lvm") || cmd.args().isEmpty() || cmd.args().size() >= maxArguments)
+        return false;
+
+    static const QRegularExpression whiteSpace(QStringLiteral("\\s"));
+    for (const auto &arg : cmd.args())
+        if (arg.isEmpty() || arg.contains(whiteSpace))
+            return false;
+
+    return start();
+}
+
+/** Starts the lvm shell if it is not running yet.
+    @return true if the shell is ready to accept commands
+*/
+bool LvmCommandSession::start()
+{
+    if (isRunning())
+        return true;
+
+    // do not retry over and over again if the shell did not work once
+    if (m_Failed)
+        return false;
+
+    stop();
+
+    m_Process = new QProcess();
+    m_Process->setEnvironment(QStringList() << QStringLiteral("LC_ALL=C") << QStringLiteral("PATH=") + QString::fromUtf8(getenv("PATH")) << QStringLiteral("LVM_SUPPRESS_FD_WARNINGS=1"));
+    m_Process->setProcessChannelMode(QProcess::SeparateChannels);
+    m_Process->start(QStringLiteral("lvm"), QStringList());
+
+    QByteArray banner;
+    if (!m_Process->waitForStarted() || !readUntilPrompt(banner, 30000)) {
+        m_Failed = true;
+        stop();
+        return false;
+    }
+
+    return true;
+}
+
+/** Quits the lvm shell. */
+void LvmCommandSession::stop()
+{
+    if (m_Process == nullptr)
+        return;
+
+    if (m_Process->state() == QProcess::Running) {
+        m_Process->write("exit\n");
+        m_Process->closeWriteChannel();
+        if (!m_Process->waitForFinished(3000))
+            m_Process->kill();
+    }
+
+    m_Process->waitForFinished(1000);
+
+    delete m_Process;
+    m_Process = nullptr;
+}
+
+/** Reads the shell's standard output until the next prompt appears.
+    @param output the output read, without the prompt
+    @param timeout timeout in milliseconds to wait for more output (-1 waits forever)
+    @return true if the prompt was seen before the timeout expired or the shell died
+*/
+bool LvmCommandSession::readUntilPrompt(QByteArray& output, int timeout)
+{
+    output += m_Process->readAllStandardOutput();
+
+    while (!output.endsWith(prompt())) {
+        if (!m_Process->waitForReadyRead(timeout))
+            return false;
+
+        output += m_Process->readAllStandardOutput();
+    }
+
+    output.chop(prompt().size());
+    return true;
+}
+
+/** Hands the shell's standard output to a command line by line as it arrives, until the next
+    prompt appears, so that line handlers and progress decoders see it while the command runs.
+    @param cmd the command to give the output to
+    @param echo the command line, dropped if the shell echoes it back as the first line
+    @param timeout timeout in milliseconds to wait for more output (-1 waits forever)
+    @return true if the prompt was seen before the timeout expired or the shell died
+*/
+bool LvmCommandSession::streamUntilPrompt(ExternalCommand& cmd, const QByteArray& echo, int timeout)
+{
+    QByteArray pending;
+    bool firstLine = true;
+
+    forever {
+        pending += m_Process->readAllStandardOutput();
+
+        const bool done = pending.endsWith(prompt());
+        if (done)
+            pending.chop(prompt().size());
+
+        // the prompt never contains a line break, so complete lines can be handed over safely
+        const int end = done ? pending.size() : qMax(pending.lastIndexOf('\n'), pending.lastIndexOf('\r')) + 1;
+
+        if (end > 0) {
+            QByteArray lines = pending.left(end);
+            pending.remove(0, end);
+
+            // depending on how lvm was built, the shell may echo the command line back to us
+            if (firstLine && lines.startsWith(echo)) {
+                const int eol = lines.indexOf('\n');
+                lines.remove(0, eol < 0 ? lines.size() : eol + 1);
+            }
+            firstLine = false;
+
+            cmd.appendOutput(QString::fromUtf8(lines));
+        }
+
+        if (done)
+            return true;
+
+        if (!m_Process->waitForReadyRead(timeout))
+            return false;
+    }
+}
+
+/** Runs an ExternalCommand through the lvm shell.
+
+    Output and exit code are stored in the ExternalCommand and the output is added to its Report
+    just as if it had been run as a separate process. Output is handed over line by line while the
+    command runs, so progress decoders (e.g. for pvmove) work inside a session, too.
+
+    @param cmd the command to run. Must have been checked with accepts() first.
+    @param timeout timeout in milliseconds to wait for the command to finish (-1 waits forever)
+    @return true if the command ran, the exit code tells if it was successful
+*/
+bool LvmCommandSession::exec(ExternalCommand& cmd, int timeout)
+{
+    Q_ASSERT(isRunning());
+
+    const QString line = cmd.args().join(QStringLiteral(" "));
+
+    if (cmd.report())
+        cmd.report()->setCommand(xi18nc("@info:status", "Command: %1 %2", cmd.command(), line));
+
+    // throw away whatever the previous command left behind on stderr
+    m_Process->readAllStandardError();
+    m_Process->write(line.toUtf8() + '\n');
+
+    if (!streamUntilPrompt(cmd, line.toUtf8(), timeout)) {
+        // the command may or may not have run: report the timeout just like ExternalCommand
+        // does and let all further commands use separate processes
+        if (cmd.report())
+            cmd.report()->line() << xi18nc("@info:status", "(Command timeout while running)");
+
+        m_Failed = true;
+        stop();
+        return false;
+    }
+
+    // give the shell's stderr a chance to be read in: the status is reported there
+    m_Process->waitForReadyRead(0);
+    const QString errors = QString::fromUtf8(m_Process->readAllStandardError());
+
+    int exitCode = 0;
+    QRegularExpressionMatch match = QRegularExpression(QStringLiteral("Command failed with status code (\\d+)")).match(errors);
+    if (match.hasMatch())
+        exitCode = match.captured(1).toInt();
+    else if (errors.contains(QStringLiteral("No such command")) || errors.contains(QStringLiteral("Too many arguments")))
+        exitCode = 3;
+
+    cmd.setExitCode(exitCode);
+    cmd.finishOutput();
+
+    m_NumCommands++;
+
+    return true;
+}
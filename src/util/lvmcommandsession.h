@@ -0,0 +1,86 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#if !defined(LVMCOMMANDSESSION__H)
+
+#define LVMCOMMANDSESSION__H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <QByteArray>
+#include <QStringList>
+#include <QtGlobal>
+
+class ExternalCommand;
+
+class QProcess;
+
+/** A long-lived LVM shell.
+
+    Starting the lvm binary, taking its locks and scanning devices dominates the run time of most
+    LVM commands. While an LvmCommandSession exists, every ExternalCommand running "lvm" in the
+    same thread is streamed to a single interactive lvm shell instead of spawning a new process.
+
+    Sessions are scoped: create one on the stack around a batch of LVM commands (a device scan or
+    an OperationRunner pass). Nested sessions reuse the outermost one. If the shell cannot be
+    started, dies, or a command cannot be expressed on the shell's command line, commands fall back
+    to running as separate processes.
+
+    @see ExternalCommand
+*/
+class LIBKPMCORE_EXPORT LvmCommandSession
+{
+    Q_DISABLE_COPY(LvmCommandSession)
+
+public:
+    /** The lvm shell refuses command lines with this many words or more, the command name included. */
+    static const qint32 maxArguments = 64;
+
+public:
+    LvmCommandSession();
+    ~LvmCommandSession();
+
+public:
+    static LvmCommandSession* current();
+
+    bool accepts(const ExternalCommand& cmd);
+    bool exec(ExternalCommand& cmd, int timeout = -1);
+
+    bool isRunning() const;
+
+    qint32 numCommands() const {
+        return m_NumCommands;    /**< @return number of commands run through the shell so far */
+    }
+
+protected:
+    bool start();
+    void stop();
+    bool readUntilPrompt(QByteArray& output, int timeout);
+    bool streamUntilPrompt(ExternalCommand& cmd, const QByteArray& echo, int timeout);
+
+    static const QByteArray& prompt();
+
+private:
+    QProcess* m_Process;
+    bool m_Owner;
+    bool m_Failed;
+    qint32 m_NumCommands;
+
+    static thread_local LvmCommandSession* s_Current;
+};
+
+#endif
@@ -22,6 +22,9 @@
 #include "backend/corebackend.h"
 #include "backend/corebackendmanager.h"
 
+#include <QMutex>
+#include <QMutexLocker>
+
 #include <KLocalizedString>
 
 #include <sys/utsname.h>
@@ -53,7 +56,12 @@ Report::~Report()
 */
 Report* Report::newChild(const QString& cmd)
 {
+    // operations on independent devices may be run concurrently and share a parent Report
+    static QMutex childrenMutex;
+
     Report* r = new Report(this, cmd);
+
+    QMutexLocker locker(&childrenMutex);
     m_Children.append(r);
     return r;
 }
@@ -129,6 +137,15 @@ void Report::addOutput(const QString& s)
     root()->emitOutputChanged();
 }
 
+/** Tells this Report and all its parents about the progress of a running command.
+    @param percent the progress in percent
+*/
+void Report::setProgress(int percent)
+{
+    for (Report* r = this; r != nullptr; r = r->parent())
+        emit r->progressChanged(percent);
+}
+
 void Report::emitOutputChanged()
 {
     emit outputChanged();
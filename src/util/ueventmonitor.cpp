@@ -0,0 +1,316 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#include "util/ueventmonitor.h"
+#include "util/externalcommand.h"
+
+#include <QByteArray>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QtEndian>
+
+#include <cstring>
+
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+
+/** netlink multicast groups of kernel and udev uevents */
+const unsigned int kernelEventGroup = 1;
+const unsigned int udevEventGroup = 2;
+
+/** how often to look at the file system again while no events come in, in milliseconds */
+const qint64 recheckInterval = 100;
+
+QByteArray readSysfs(const QString& path)
+{
+    QFile f(path);
+
+    if (!f.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    return f.readAll().trimmed();
+}
+
+/** @return the kernel's name for a partition of a disk, e.g. sda3 or nvme0n1p3 */
+QString partitionName(const QString& diskName, qint32 number)
+{
+    if (!diskName.isEmpty() && diskName.at(diskName.size() - 1).isDigit())
+        return diskName + QStringLiteral("p") + QString::number(number);
+
+    return diskName + QString::number(number);
+}
+
+}
+
+/** Creates a new UeventMonitor and subscribes to block device events. */
+UeventMonitor::UeventMonitor() :
+    m_Socket(-1),
+    m_Udev(QFileInfo::exists(QStringLiteral("/run/udev/control"))),
+    m_Expected()
+{
+    m_Socket = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+
+    if (m_Socket == -1)
+        return;
+
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = m_Udev ? udevEventGroup : kernelEventGroup;
+
+    const int on = 1;
+
+    if (bind(m_Socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            setsockopt(m_Socket, SOL_SOCKET, SO_PASSCRED, &on, sizeof(on)) != 0) {
+        close(m_Socket);
+        m_Socket = -1;
+    }
+}
+
+UeventMonitor::~UeventMonitor()
+{
+    if (m_Socket != -1)
+        close(m_Socket);
+}
+
+/** Adds a device node to wait for.
+    @param deviceNode the node, e.g. /dev/sda3
+    @param action whether the node is expected to appear or to go away
+*/
+void UeventMonitor::expect(const QString& deviceNode, Action action)
+{
+    Expectation e;
+    e.deviceNode = deviceNode;
+    e.action = action;
+    e.seen = false;
+
+    m_Expected.append(e);
+}
+
+/** Compares the partitions the kernel currently knows on a disk with the partitions a commit is
+    about to write, and expects the nodes that have to appear or go away.
+
+    Partitions that keep their number and start are resized in place by the kernel and do not
+    get new nodes, so they are not waited for. Neither are partitions of image files, loop
+    devices without partition scanning and device mapper disks: the kernel never creates
+    nodes for them.
+
+    @param deviceNode the disk, e.g. /dev/sda
+    @param partitions partition numbers of the new table mapped to their start in bytes
+*/
+void UeventMonitor::expectPartitions(const QString& deviceNode, const QMap<qint32, qint64>& partitions)
+{
+    const QString diskName = QFileInfo(QFileInfo(deviceNode).canonicalFilePath()).fileName();
+    const QString sysfs = QStringLiteral("/sys/class/block/%1/").arg(diskName);
+
+    // ext_range is the number of minors the disk may use, 1 if it cannot have partitions
+    if (!QFileInfo(sysfs).isDir() || readSysfs(sysfs + QStringLiteral("ext_range")).toInt() <= 1 ||
+            QFileInfo::exists(sysfs + QStringLiteral("dm")))
+        return;
+
+    QMap<qint32, qint64> current;
+    const QStringList entries = QDir(sysfs).entryList(QStringList() << diskName + QStringLiteral("*"), QDir::Dirs | QDir::NoDotAndDotDot);
+
+    for (const auto &name : entries) {
+        bool ok = false;
+        const qint32 number = readSysfs(sysfs + name + QStringLiteral("/partition")).toInt(&ok);
+
+        if (!ok)
+            continue;
+
+        // sysfs counts in 512 byte units no matter what the logical sector size is
+        current[number] = readSysfs(sysfs + name + QStringLiteral("/start")).toLongLong() * 512;
+
+        if (!partitions.contains(number))
+            expect(QStringLiteral("/dev/") + name, Remove);
+        else if (partitions[number] != current[number])
+            expect(QStringLiteral("/dev/") + name, Add);
+    }
+
+    for (auto it = partitions.constBegin(); it != partitions.constEnd(); ++it)
+        if (!current.contains(it.key()))
+            expect(QStringLiteral("/dev/") + partitionName(diskName, it.key()), Add);
+}
+
+/** Waits until all expected device nodes have been added or removed.
+    @param timeout the maximum time to wait in seconds
+    @return true if all nodes are there (or gone) in time; see lateNodes() otherwise
+*/
+bool UeventMonitor::wait(quint32 timeout)
+{
+    if (m_Expected.isEmpty())
+        return true;
+
+    if (!isValid()) {
+        if (!ExternalCommand(QStringLiteral("udevadm"), QStringList() << QStringLiteral("settle") << QStringLiteral("--timeout=") + QString::number(timeout)).run() &&
+                !ExternalCommand(QStringLiteral("udevsettle"), QStringList() << QStringLiteral("--timeout=") + QString::number(timeout)).run())
+            sleep(timeout);
+
+        return true;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const qint64 limit = static_cast<qint64>(timeout) * 1000;
+
+    forever {
+        readEvents();
+
+        if (lateNodes().isEmpty())
+            return true;
+
+        const qint64 remaining = limit - timer.elapsed();
+        if (remaining <= 0)
+            return false;
+
+        // symlinks may show up shortly after their event, so look again now and then
+        struct pollfd pfd;
+        pfd.fd = m_Socket;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        poll(&pfd, 1, static_cast<int>(qMin(remaining, recheckInterval)));
+    }
+}
+
+/** @return the expected device nodes that have not been added or removed yet */
+QStringList UeventMonitor::lateNodes() const
+{
+    QStringList rval;
+
+    for (qint32 i = 0; i < m_Expected.size(); i++)
+        if (!isSatisfied(i))
+            rval.append(m_Expected[i].deviceNode);
+
+    return rval;
+}
+
+/** Reads all pending uevents without blocking and records those of expected nodes. */
+void UeventMonitor::readEvents()
+{
+    char buffer[8192];
+    char control[CMSG_SPACE(sizeof(struct ucred))];
+
+    forever {
+        struct iovec iov;
+        iov.iov_base = buffer;
+        iov.iov_len = sizeof(buffer);
+
+        struct sockaddr_nl sender;
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = &sender;
+        msg.msg_namelen = sizeof(sender);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        const ssize_t n = recvmsg(m_Socket, &msg, 0);
+        if (n <= 0)
+            return;
+
+        // only root (the kernel or udevd) may tell us about device nodes
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        if (cmsg == nullptr || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_CREDENTIALS ||
+                reinterpret_cast<struct ucred*>(CMSG_DATA(cmsg))->uid != 0)
+            continue;
+
+        const QByteArray data(buffer, n);
+        QByteArray properties;
+
+        if (data.startsWith("libudev")) {
+            // libudev header: prefix[8], magic, header size, properties offset, properties length, ...
+            if (n < 24 || qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(buffer) + 8) != 0xfeedcafe)
+                continue;
+
+            quint32 offset;
+            quint32 length;
+            memcpy(&offset, buffer + 16, sizeof(offset));
+            memcpy(&length, buffer + 20, sizeof(length));
+
+            if (static_cast<qint64>(offset) + length > n)
+                continue;
+
+            properties = data.mid(offset, length);
+        } else {
+            // kernel: "action@devpath" followed by the properties
+            const int start = data.indexOf('\0');
+            if (start < 0)
+                continue;
+
+            properties = data.mid(start + 1);
+        }
+
+        QHash<QByteArray, QByteArray> env;
+        for (const auto &property : properties.split('\0')) {
+            const int eq = property.indexOf('=');
+            if (eq > 0)
+                env.insert(property.left(eq), property.mid(eq + 1));
+        }
+
+        if (env.value("SUBSYSTEM") != "block")
+            continue;
+
+        QString node = QString::fromLocal8Bit(env.value("DEVNAME"));
+        if (!node.startsWith(QLatin1Char('/')))
+            node.prepend(QStringLiteral("/dev/"));
+
+        const QByteArray action = env.value("ACTION");
+
+        for (auto &e : m_Expected) {
+            if (e.deviceNode != node)
+                continue;
+
+            if (e.action == Add && (action == "add" || action == "change")) {
+                e.seen = true;
+                e.links = QString::fromLocal8Bit(env.value("DEVLINKS")).split(QLatin1Char(' '), QString::SkipEmptyParts);
+            } else if (e.action == Remove && action == "remove")
+                e.seen = true;
+        }
+    }
+}
+
+/** @return true if an expected node has been added with all its symlinks, or has gone away */
+bool UeventMonitor::isSatisfied(qint32 i) const
+{
+    const Expectation& e = m_Expected[i];
+
+    // without udev there is no one to wait for but the kernel's devtmpfs
+    if (m_Udev && !e.seen)
+        return false;
+
+    if (e.action == Remove)
+        return !QFileInfo::exists(e.deviceNode);
+
+    if (!QFileInfo::exists(e.deviceNode))
+        return false;
+
+    for (const auto &link : e.links)
+        if (!QFileInfo::exists(link))
+            return false;
+
+    return true;
+}
@@ -0,0 +1,86 @@
+/*************************************************************************
+ *  Copyright (C) 2026 by Andrius Štikonas <andrius@stikonas.eu>         *
+ *                                                                       *
+ *  This program is free software; you can redistribute it and/or        *
+ *  modify it under the terms of the GNU General Public License as       *
+ *  published by the Free Software Foundation; either version 3 of       *
+ *  the License, or (at your option) any later version.                  *
+ *                                                                       *
+ *  This program is distributed in the hope that it will be useful,      *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ *  GNU General Public License for more details.                         *
+ *                                                                       *
+ *  You should have received a copy of the GNU General Public License    *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ *************************************************************************/
+
+#if !defined(UEVENTMONITOR__H)
+
+#define UEVENTMONITOR__H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+/** Waits for the device nodes of a partition table commit.
+
+    Waiting for "udevadm settle" waits for everything udev has queued on the whole system.
+    An UeventMonitor instead subscribes to the uevents udev (or, without udev, the kernel)
+    broadcasts over netlink and only waits for the partition nodes a commit adds or removes.
+
+    Create the monitor before committing so that no event can be missed, tell it which nodes to
+    expect and call wait() after the commit. If the netlink socket cannot be opened, wait()
+    falls back to "udevadm settle".
+
+    @author Andrius Štikonas <andrius@stikonas.eu>
+*/
+class LIBKPMCORE_EXPORT UeventMonitor
+{
+    Q_DISABLE_COPY(UeventMonitor)
+
+public:
+    /** What is expected to happen to a device node */
+    enum Action {
+        Add,        /**< the node and all its symlinks exist */
+        Remove      /**< the node is gone */
+    };
+
+public:
+    UeventMonitor();
+    ~UeventMonitor();
+
+public:
+    bool isValid() const {
+        return m_Socket != -1;    /**< @return true if the netlink socket is open */
+    }
+
+    void expect(const QString& deviceNode, Action action);
+    void expectPartitions(const QString& deviceNode, const QMap<qint32, qint64>& partitions);
+
+    bool wait(quint32 timeout);
+
+    QStringList lateNodes() const;
+
+protected:
+    void readEvents();
+    bool isSatisfied(qint32 i) const;
+
+private:
+    struct Expectation {
+        QString deviceNode;
+        Action action;
+        bool seen;
+        QStringList links;
+    };
+
+    int m_Socket;
+    bool m_Udev;
+    QList<Expectation> m_Expected;
+};
+
+#endif